@@ -0,0 +1,89 @@
+#include "isaac/array.h"
+#include "isaac/jit/generation/engine/stream.h"
+#include "isaac/jit/generation/elementwise_1d.h"
+#include "isaac/jit/generation/reduce_1d.h"
+#include "isaac/jit/generation/gemm.h"
+#include <iomanip>
+#include <memory>
+#include "common.hpp"
+
+namespace tpt = isaac::templates;
+
+Timer tmr;
+
+template<class OP>
+double bench(OP const & op)
+{
+  std::vector<long> times;
+  double total_time = 0;
+  op();
+  while(total_time*1e-9 < 2e-1){
+    tmr.start();
+    op();
+    times.push_back(tmr.get().count());
+    total_time+=times.back();
+  }
+  return min(times);
+}
+
+//Throughput of the keyword substitution, on sources of increasing size
+void bench_stream(sc::driver::backend_type backend, std::string const & name)
+{
+  for(int N: {16, 256, 4096})
+  {
+    sc::kernel_generation_stream stream(backend);
+    stream << "$KERNEL void kernel($GLOBAL float* x, $SIZE_T N)" << std::endl;
+    stream << "{" << std::endl;
+    stream.inc_tab();
+    stream << "$LOCAL float buf[256];" << std::endl;
+    for(int i = 0 ; i < N ; ++i)
+    {
+      stream << "for(unsigned int i = $GLOBAL_IDX_0; i < N; i += $GLOBAL_SIZE_0)" << std::endl;
+      stream << "  buf[$LOCAL_IDX_0] = $MAD(x[i], x[$GROUP_IDX_0], buf[$LOCAL_IDX_0]);" << std::endl;
+      stream << "$LOCAL_BARRIER;" << std::endl;
+    }
+    stream.dec_tab();
+    stream << "}" << std::endl;
+    size_t size = 0;
+    double time = bench([&](){ size = stream.str().size(); });
+    std::cout << name << "," << size << "," << std::setprecision(4) << size/time*1e3 << std::endl;
+  }
+}
+
+//Source generation of the templates for common BLAS expressions
+void bench_templates()
+{
+  sc::int_t N = 1024;
+  sc::array x(N, sc::FLOAT_TYPE), y(N, sc::FLOAT_TYPE), A(N, N, sc::FLOAT_TYPE), B(N, N, sc::FLOAT_TYPE), C(N, N, sc::FLOAT_TYPE);
+  sc::scalar s(sc::FLOAT_TYPE);
+  sc::driver::Device const & device = x.context().device();
+  std::vector<std::tuple<std::string, std::shared_ptr<tpt::base>, sc::expression_tree> > cases = {
+    std::make_tuple("axpy", std::make_shared<tpt::elementwise_1d>(1, 128, 64), sc::assign(y, 2*x + y)),
+    std::make_tuple("dot", std::make_shared<tpt::reduce_1d>(1, 128, 64), sc::assign(s, dot(x, y))),
+    std::make_tuple("gemm", std::make_shared<tpt::gemm_nn>(1, 8, 8, 8, 1, 4, 1, 4, 8, 8), sc::assign(C, dot(A, B)))
+  };
+  for(auto const & x: cases)
+  {
+    size_t size = 0;
+    double time = bench([&](){ size = std::get<1>(x)->generate("0", std::get<2>(x), device).size(); });
+    std::cout << std::get<0>(x) << "," << size << "," << std::setprecision(4) << time*1e-3 << std::endl;
+  }
+}
+
+int main()
+{
+  std::cout << "#Keyword substitution" << std::endl;
+  std::cout << "Backend,Bytes,MB/s" << std::endl;
+  bench_stream(sc::driver::OPENCL, "OpenCL");
+  bench_stream(sc::driver::CUDA, "CUDA");
+
+  std::cout << "#Template generation" << std::endl;
+  try{
+    sc::driver::backend::contexts::get_default();
+  }catch(std::exception const & e){
+    std::cout << "Skipped: " << e.what() << std::endl;
+    return EXIT_SUCCESS;
+  }
+  std::cout << "Expression,Bytes,Time (us)" << std::endl;
+  bench_templates();
+}
@@ -0,0 +1,36 @@
+#include <iostream>
+#include "isaac/array.h"
+#include "isaac/runtime/tuner.h"
+
+namespace sc = isaac;
+
+int main()
+{
+    static const char * dline = "====================";
+
+    std::cout << dline << std::endl;
+    std::cout << "Tutorial: Online tuning " << std::endl;
+    std::cout << dline << std::endl;
+
+    sc::driver::Context const & context = sc::driver::backend::contexts::get_default();
+    sc::driver::CommandQueue & queue = sc::driver::backend::queues::get(context);
+
+    //A shape that matters to the application
+    sc::int_t M = 1536, N = 1536, K = 1536;
+    sc::array A(M, K, sc::FLOAT_TYPE, context), B(K, N, sc::FLOAT_TYPE, context), C(M, N, sc::FLOAT_TYPE, context);
+
+    //Search for at most 64 candidates or 60 seconds
+    sc::runtime::tuner tuner(sc::runtime::tuner::options_type(64, 60));
+    sc::runtime::tuner::result_type result = tuner.run(sc::assign(C, sc::dot(A, B)), queue);
+    if(result.parameters.empty())
+    {
+      std::cout << "No valid template found" << std::endl;
+      return 1;
+    }
+    std::cout << "Best of " << result.evaluations << " candidates: " << 2*M*N*K/result.time*1e-9 << " GFLOPS" << std::endl;
+
+    //Subsequent products of this shape use the new template
+    sc::runtime::tuner::apply(result, queue);
+    C = sc::dot(A, B);
+    queue.synchronize();
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include "isaac/array.h"
+#include "isaac/runtime/warmup.h"
+
+namespace sc = isaac;
+
+int main(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+      std::cerr << "Usage: " << argv[0] << " BUNDLE" << std::endl;
+      return 1;
+    }
+    static const char * dline = "====================";
+
+    std::cout << dline << std::endl;
+    std::cout << "Tutorial: Warm-up " << std::endl;
+    std::cout << dline << std::endl;
+
+    sc::driver::CommandQueue & queue = sc::driver::backend::queues::get(sc::driver::backend::contexts::get_default());
+
+    //Compile and tune the BLAS operations for the shapes the application will use
+    std::vector<sc::expression_type> operations = {sc::ELEMENTWISE_1D, sc::REDUCE_1D, sc::REDUCE_2D_ROWS, sc::REDUCE_2D_COLS, sc::GEMM_NN, sc::GEMM_TN};
+    std::vector<sc::numeric_type> dtypes = {sc::FLOAT_TYPE};
+    std::vector<std::vector<sc::int_t> > shapes = {{256, 256, 256}, {1024, 1024, 1024}};
+    sc::runtime::warmup(operations, dtypes, shapes, queue);
+
+    //Save everything; a later run on the same device can call import_bundle() and skip compilation
+    sc::runtime::export_bundle(argv[1], queue);
+    std::cout << "Kernel bundle written to " << argv[1] << std::endl;
+}
@@ -56,6 +56,23 @@ inline expression_type expression_type_from_string(std::string const & name)
   throw std::invalid_argument("Unrecognized expression: " + name);
 }
 
+inline std::string to_string(expression_type type)
+{
+  switch(type)
+  {
+    case ELEMENTWISE_1D: return "elementwise_1d";
+    case REDUCE_1D: return "reduce_1d";
+    case ELEMENTWISE_2D: return "elementwise_2d";
+    case REDUCE_2D_ROWS: return "reduce_2d_rows";
+    case REDUCE_2D_COLS: return "reduce_2d_cols";
+    case GEMM_NN: return "gemm_nn";
+    case GEMM_NT: return "gemm_nt";
+    case GEMM_TN: return "gemm_tn";
+    case GEMM_TT: return "gemm_tt";
+    default: throw std::invalid_argument("Unrecognized expression type");
+  }
+}
+
 
 }
 
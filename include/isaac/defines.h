@@ -22,6 +22,8 @@
 #ifndef ISAAC_DEFINES_H
 #define ISAAC_DEFINES_H
 
+#define ISAAC_VERSION "1.0"
+
 #if defined(_WIN32) || defined(_MSC_VER)
     #ifdef ISAAC_DLL
         #define ISAACAPI  __declspec(dllexport)
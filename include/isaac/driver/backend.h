@@ -22,8 +22,12 @@
 #ifndef ISAAC_CL_QUEUES_H
 #define ISAAC_CL_QUEUES_H
 
+#include <functional>
 #include <map>
 #include <list>
+#include <string>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include "isaac/common/expression_type.h"
@@ -41,6 +45,7 @@ namespace driver
 class Buffer;
 class CommandQueue;
 class Context;
+class Device;
 class Platform;
 class Program;
 class Kernel;
@@ -51,9 +56,11 @@ class ISAACAPI backend
 public:
   class ISAACAPI workspaces
   {
+      friend class backend;
   public:
       static const size_t SIZE = 8000000; //8MB of temporary workspace per queue
       static void release();
+      static void release(CommandQueue const & key);
       static driver::Buffer & get(CommandQueue const & key);
   private:
       DISABLE_MSVC_WARNING_C4251
@@ -65,11 +72,30 @@ public:
   {
       friend class backend;
   public:
+      struct statistics
+      {
+          size_t caches;
+          size_t programs;
+          size_t bytes;
+          size_t hits;
+          size_t misses;
+          size_t evictions;
+      };
+
       static void release();
-      static ProgramCache & get(CommandQueue const & queue, expression_type expression, numeric_type dtype);
+      //Releases the programs of a context, and their kernels
+      static void release(Context const & context);
+      //Programs are shared by every queue of a context
+      static ProgramCache & get(Context const & context, expression_type expression, numeric_type dtype);
+      //Evicts the least recently used programs of every cache until at most n remain in each
+      static void trim(size_t n = 0);
+      //Maximum number of programs of each cache, for existing and future caches
+      static void set_capacity(size_t capacity);
+      static statistics stats();
   private:
 DISABLE_MSVC_WARNING_C4251
-      static std::map<std::tuple<CommandQueue, expression_type, numeric_type>, ProgramCache * > cache_;
+      static std::map<std::tuple<Context, expression_type, numeric_type>, ProgramCache * > cache_;
+      static size_t capacity_;
 RESTORE_MSVC_WARNING_C4251
   };
 
@@ -78,6 +104,8 @@ RESTORE_MSVC_WARNING_C4251
       friend class backend;
   public:
       static void release();
+      //Releases the kernels of a program, before it is itself released
+      static void release(Program const & program);
       static Kernel & get(Program const & program, std::string const & name);
   private:
 DISABLE_MSVC_WARNING_C4251
@@ -92,13 +120,26 @@ RESTORE_MSVC_WARNING_C4251
       static void init(std::vector<Platform> const &);
       static void release();
   public:
+      //Contexts are only created when their device is first used
       static Context const & get_default();
+      static Context const & get(Device const & device);
       static Context const & import(CUcontext context);
+      //Foreign OpenCL contexts are retained until a sweep finds that only we still reference them
       static Context const & import(cl_context context);
+      //Called with every foreign context that a sweep releases, so that other layers drop their state on it
+      static void on_release(std::function<void(Context const &)> const & callback);
+      //Creates the context of every device
       static void get(std::list<Context const *> &);
+      //Lists the devices of the selected platforms, without creating contexts
+      static void devices(std::vector<Device> &);
   private:
 DISABLE_MSVC_WARNING_C4251
+      static std::vector<Device> devices_;
+      static std::vector<Context const *> owned_;
       static std::list<Context const *> cache_;
+      static std::unordered_map<cl_context, Context const *> cl_index_;
+      static std::unordered_map<CUcontext, Context const *> cu_index_;
+      static std::vector<std::function<void(Context const &)> > callbacks_;
 RESTORE_MSVC_WARNING_C4251
   };
 
@@ -111,21 +152,35 @@ RESTORE_MSVC_WARNING_C4251
   public:
       static void get(Context const &, std::vector<CommandQueue *> &queues);
       static CommandQueue & get(Context const &, unsigned int id = 0);
+      //Wrapper of a foreign queue. The queue and its workspace are kept until an import follows its release by the application
+      static CommandQueue & import(cl_command_queue queue);
+  private:
+      static void sweep();
   private:
 DISABLE_MSVC_WARNING_C4251
       static std::map< Context, std::vector<CommandQueue*> > cache_;
+      static std::unordered_map<cl_command_queue, CommandQueue*> foreign_;
 RESTORE_MSVC_WARNING_C4251
   };
 
   static void init();
   static void release();
+  static void sweep();
 
   static void platforms(std::vector<Platform> &);
+  //Only platforms whose name contains one of the given strings (case-insensitive, "CUDA" for the CUDA backend) are used.
+  //Defaults to the comma-separated list in ISAAC_PLATFORMS. Must be called before any device is used
+  static void restrict_platforms(std::vector<std::string> const & names);
   static void synchronize(Context const &);
 
 public:
   static unsigned int default_device;
   static cl_command_queue_properties default_queue_properties;
+
+private:
+DISABLE_MSVC_WARNING_C4251
+  static std::vector<std::string> platforms_filter_;
+RESTORE_MSVC_WARNING_C4251
 };
 
 }
@@ -24,6 +24,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 #include "isaac/defines.h"
 #include "isaac/driver/common.h"
 #include "isaac/driver/device.h"
@@ -40,6 +41,7 @@ class ISAACAPI Context: public has_handle_comparators<Context>
   friend class Program;
   friend class CommandQueue;
   friend class Buffer;
+  friend class DiskCache;
 
 public:
   typedef Handle<cl_context, CUcontext> handle_type;
@@ -62,13 +64,13 @@ public:
   //Accessors
   backend_type backend() const;
   Device const & device() const;
+  std::vector<Device> devices() const;
   handle_type const & handle() const;
 
 private:
 DISABLE_MSVC_WARNING_C4251
   backend_type backend_;
   Device device_;
-  std::string cache_path_;
   handle_type h_;
 RESTORE_MSVC_WARNING_C4251
 };
@@ -22,6 +22,10 @@
 #ifndef ISAAC_DRIVER_DEVICE_H
 #define ISAAC_DRIVER_DEVICE_H
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "isaac/defines.h"
 #include "isaac/driver/common.h"
 #include "isaac/driver/platform.h"
@@ -88,10 +92,40 @@ public:
       UNKNOWN
   };
 
+  /** @brief Immutable properties, queried once per device */
+  struct properties_type
+  {
+    std::string name;
+    std::string vendor_str;
+    Vendor vendor;
+    Architecture architecture;
+    Type type;
+    std::string extensions;
+    unsigned int address_bits;
+    size_t clock_rate;
+    size_t compute_units;
+    size_t max_work_group_size;
+    std::vector<size_t> max_work_item_sizes;
+    size_t local_mem_size;
+  };
+
 private:
   //Metaprogramming elper to get cuda info from attribute
   template<CUdevice_attribute attr>
   int cuGetInfo() const;
+  //Driver queries
+  static Vendor query_vendor(std::string vendor_str);
+  Architecture query_architecture(Vendor vendor, std::string const & name) const;
+  std::string query_name() const;
+  std::string query_vendor_str() const;
+  Type query_type() const;
+  std::string query_extensions() const;
+  unsigned int query_address_bits() const;
+  size_t query_clock_rate() const;
+  size_t query_compute_units() const;
+  size_t query_max_work_group_size() const;
+  std::vector<size_t> query_max_work_item_sizes() const;
+  size_t query_local_mem_size() const;
 
 public:
   //Constructors
@@ -102,13 +136,16 @@ public:
   Vendor vendor() const;
   Architecture architecture() const;
   backend_type backend() const;
+  properties_type const & properties() const;
   //Informations
   std::string infos() const;
   size_t clock_rate() const;
+  size_t compute_units() const;
   unsigned int address_bits() const;
   driver::Platform platform() const;
   std::string name() const;
   std::string vendor_str() const;
+  std::string driver_version() const;
   std::vector<size_t> max_work_item_sizes() const;
   Type type() const;
   std::string extensions() const;
@@ -121,6 +158,7 @@ public:
 private:
   backend_type backend_;
   handle_type h_;
+  mutable std::shared_ptr<properties_type const> properties_;
 };
 
 }
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_DRIVER_DISK_CACHE_H
+#define ISAAC_DRIVER_DISK_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "isaac/defines.h"
+
+namespace isaac
+{
+
+namespace driver
+{
+
+class Device;
+
+/** @brief Size-capped on-disk cache of program binaries.
+ *
+ *  Entries live in one file each and are listed, with their size and last use, in an index file.
+ *  Every file is written to a temporary name and renamed into place, so that concurrent processes
+ *  sharing the directory never observe partial entries. When the cache grows beyond its capacity,
+ *  the least recently used entries are removed. Files unknown to the index (written by another process)
+ *  are adopted on first use.
+ */
+class ISAACAPI DiskCache
+{
+  struct entry
+  {
+    uint64_t size;
+    uint64_t last_use;
+  };
+
+public:
+  struct statistics
+  {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t writes;
+    uint64_t evictions;
+    uint64_t size;
+  };
+
+public:
+  //An empty path disables the cache
+  DiskCache(std::string const & path, uint64_t capacity);
+  ~DiskCache();
+  //Key of a binary for a given device. The driver version is included since binaries do not survive driver upgrades
+  static std::string key(Device const & device, std::string const & source);
+  //Returns false on misses
+  bool load(std::string const & key, std::string & binary);
+  void store(std::string const & key, std::string const & binary);
+  //Removes every entry
+  void clear();
+  //Accessors
+  std::string const & path() const;
+  uint64_t capacity() const;
+  void set_capacity(uint64_t capacity);
+  statistics stats() const;
+  //Cache at Context::cache_path(), capped by ISAAC_CACHE_SIZE (in MB, default 256)
+  static DiskCache & get();
+
+private:
+  std::string fname(std::string const & key) const;
+  void read_index();
+  void write_index();
+  void sync();
+  void evict();
+  bool write_atomic(std::string const & fname, std::string const & data);
+
+private:
+DISABLE_MSVC_WARNING_C4251
+  std::string path_;
+  uint64_t capacity_;
+  uint64_t clock_;
+  bool dirty_;
+  std::map<std::string, entry> index_;
+  statistics stats_;
+  mutable std::mutex mutex_;
+RESTORE_MSVC_WARNING_C4251
+};
+
+}
+
+}
+
+#endif
@@ -108,6 +108,8 @@ public:
     static cl_program clCreateProgramWithBinary(cl_context, cl_uint, const cl_device_id *, const size_t *, const unsigned char **, cl_int *, cl_int *);
     static cl_command_queue clCreateCommandQueue(cl_context, cl_device_id, cl_command_queue_properties, cl_int *);
     static cl_int clRetainEvent(cl_event);
+    static cl_int clRetainCommandQueue(cl_command_queue);
+    static cl_int clRetainContext(cl_context);
     static cl_int clReleaseProgram(cl_program);
     static cl_int clFlush(cl_command_queue);
     static cl_int clGetProgramInfo(cl_program, cl_program_info, size_t, void *, size_t *);
@@ -194,6 +196,8 @@ private:
     static void* clCreateProgramWithBinary_;
     static void* clCreateCommandQueue_;
     static void* clRetainEvent_;
+    static void* clRetainCommandQueue_;
+    static void* clRetainContext_;
     static void* clReleaseProgram_;
     static void* clFlush_;
     static void* clGetProgramInfo_;
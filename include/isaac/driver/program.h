@@ -47,16 +47,25 @@ private:
 
 public:
   //Constructors
-  Program(Context const & context, std::string const & source);
+  Program(Context const & context, std::string const & source, bool use_cache = true);
+  //Loading the binaries previously obtained from binaries(), one per device of the context
+  static Program load(Context const & context, std::vector<std::string> const & binaries);
   //Accessors
   handle_type const & handle() const;
   Context const & context() const;
+  //Device binaries (OpenCL), in the order of Context::devices(), or PTX (CUDA)
+  std::vector<std::string> binaries() const;
+  size_t binary_size() const;
+
+private:
+  Program(Context const & context);
 
 private:
 DISABLE_MSVC_WARNING_C4251
   backend_type backend_;
   Context context_;
   std::string source_;
+  std::string ptx_;
   handle_type h_;
 RESTORE_MSVC_WARNING_C4251
 };
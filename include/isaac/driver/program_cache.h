@@ -22,6 +22,7 @@
 #ifndef ISAAC_DRIVER_PROGRAM_CACHE_H
 #define ISAAC_DRIVER_PROGRAM_CACHE_H
 
+#include <list>
 #include <map>
 #include "isaac/defines.h"
 #include "isaac/driver/program.h"
@@ -32,21 +33,64 @@ namespace isaac
 namespace driver
 {
 
+/** @brief Compiled programs of a (queue, operation, dtype) triple, with least-recently-used eviction */
 class ISAACAPI ProgramCache
 {
     friend class backend;
 
+    struct entry
+    {
+        Program program;
+        size_t bytes;
+        std::list<std::string>::iterator lru;
+    };
+
+public:
+    struct statistics
+    {
+        size_t programs;
+        size_t bytes;
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+    };
+
 public:
+    ProgramCache(size_t capacity = DEFAULT_CAPACITY);
     //Clearing the cache
     void clear();
-    //Adding a program to the cache
-    Program & add(Context const & context, std::string const & name, std::string const & src);
+    //Adding a program to the cache. Recompiling replaces any existing program of the same name
+    Program & add(Context const & context, std::string const & name, std::string const & src, bool recompile = false);
+    //Adding an already compiled program to the cache
+    Program & add(std::string const & name, Program const & program);
+    //Compiling a program as add() would, without caching it in memory
+    static Program compile(Context const & context, std::string const & src, bool use_cache = true);
     //Finding a program in the cache
     Program const *find(std::string const & name);
+    //Removing a program from the cache, if present
+    void erase(std::string const & name);
+    //Cached programs, by name
+    std::map<std::string, Program> programs() const;
+    //Evicting the least recently used programs until at most n remain
+    void trim(size_t n = 0);
+    //Maximum number of programs. Adding programs beyond it evicts the least recently used ones
+    size_t capacity() const;
+    void set_capacity(size_t capacity);
+    statistics const & stats() const;
+
+private:
+    Program & insert(std::string const & name, Program const & program);
+    void erase(std::map<std::string, entry>::iterator it);
+
+public:
+    static const size_t DEFAULT_CAPACITY = 128;
 
 private:
 DISABLE_MSVC_WARNING_C4251
-    std::map<std::string, Program> cache_;
+    std::map<std::string, entry> cache_;
+    std::list<std::string> lru_;
+    size_t capacity_;
+    statistics stats_;
 RESTORE_MSVC_WARNING_C4251
 };
 
@@ -64,6 +64,13 @@ static const int TEMPLATE_LOCAL_FETCH_1_MUST_BE_ML_MULTIPLE = -18;
 static const int TEMPLATE_TEMPORARY_TOO_LARGE = -19;
 static const int TEMPLATE_BLOCK_SIZE_TOO_LARGE = -20;
 
+//Valid, but not worth benchmarking
+static const int TEMPLATE_REGISTER_SPILL = -21;
+static const int TEMPLATE_LOW_OCCUPANCY = -22;
+static const int TEMPLATE_TOO_FEW_WORK_GROUPS = -23;
+static const int TEMPLATE_LOW_ARITHMETIC_INTENSITY = -24;
+static const int TEMPLATE_MISALIGNED_SIMD_WIDTH = -25;
+
 class base: public std::enable_shared_from_this<base>
 {
 private:
@@ -75,11 +82,20 @@ public:
   virtual unsigned int lmem_usage(expression_tree const &) const;
   virtual unsigned int registers_usage(expression_tree const &) const;
   virtual std::vector<int_t> input_sizes(expression_tree const & expressions) const = 0;
+  /** @brief Input sizes, followed by what changes performance at equal sizes: number of operands, largest element stride,
+   *  largest padding of a leading dimension, and smallest alignment of the leading dimensions and of the offsets, in elements */
+  std::vector<int_t> input_features(expression_tree const & expressions) const;
   virtual int is_invalid(expression_tree const & expressions, driver::Device const & device) const = 0;
+  /** @brief Analytic pre-filter of valid templates, from estimated register use, occupancy, work-group count and arithmetic intensity */
+  virtual int is_implausible(expression_tree const & expressions, driver::Device const & device) const;
   virtual void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const & expressions) = 0;
   virtual expression_type type() const = 0;
+  /** @brief Tuning parameters, in the order of the constructor. Together with type(), they identify the generated code */
+  virtual std::vector<int> parameters() const;
   std::string generate(std::string const & suffix, expression_tree const & expressions, driver::Device const & device);
   std::shared_ptr<base> getptr();
+  /** @brief Identifies the sources of the generators, so that cached binaries do not outlive changes to them */
+  static std::string generator_id();
 };
 
 class external_base: public base
@@ -98,6 +114,10 @@ class parameterized_base : public base
 {
 private:
   virtual int is_invalid_impl(driver::Device const &, expression_tree const &) const;
+  virtual int is_implausible_impl(driver::Device const &, expression_tree const &) const;
+
+protected:
+  int check_work_groups(driver::Device const & device, size_t work_groups, size_t parallelism) const;
 
 public:
   parameterized_base(unsigned int _vwidth, int_t _ls0, int_t _ls1);
@@ -105,6 +125,7 @@ public:
   unsigned int ls1() const;
   /** @brief returns whether or not the profile has undefined behavior on particular device */
   int is_invalid(expression_tree const & expressions, driver::Device const & device) const;
+  int is_implausible(expression_tree const & expressions, driver::Device const & device) const;
 protected:
   unsigned int vwidth_;
   unsigned int ls0_;
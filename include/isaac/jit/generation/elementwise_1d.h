@@ -32,12 +32,14 @@ namespace templates
 class elementwise_1d : public parameterized_base
 {
 private:
+  int is_implausible_impl(driver::Device const &, expression_tree const &) const;
   std::string generate_impl(std::string const & suffix, expression_tree const  & expressions, driver::Device const & device, symbolic::symbols_table const & symbols) const;
 public:
   elementwise_1d(unsigned int vwidth, unsigned int ls, unsigned int ng);
   std::vector<int_t> input_sizes(expression_tree const  & expressions) const;
   void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const &);
   expression_type type() const;
+  std::vector<int> parameters() const;
 private:
   unsigned int ng_;
 };
@@ -34,12 +34,14 @@ class elementwise_2d : public parameterized_base
 {
 private:
   int is_invalid_impl(driver::Device const &, expression_tree const  &) const;
+  int is_implausible_impl(driver::Device const &, expression_tree const &) const;
   std::string generate_impl(std::string const & suffix, expression_tree const  & expressions, driver::Device const & device, symbolic::symbols_table const & mapping) const;
 public:
   elementwise_2d(unsigned int vwidth, unsigned int ls0, unsigned int ls1,  unsigned int ng0, unsigned int ng1);
   std::vector<int_t> input_sizes(expression_tree const  & expressions) const;
   void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const &);
   expression_type type() const;
+  std::vector<int> parameters() const;
 private:
   unsigned int ng0_;
   unsigned int ng1_;
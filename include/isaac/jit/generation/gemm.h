@@ -53,6 +53,7 @@ private:
   unsigned int lmem_usage(expression_tree const & expressions) const;
   unsigned int registers_usage(expression_tree const & expressions) const;
   int is_invalid_impl(driver::Device const &, expression_tree const &) const;
+  int is_implausible_impl(driver::Device const &, expression_tree const &) const;
   std::string generate_impl(std::string const & suffix, expression_tree const & expressions, driver::Device const & device, symbolic::symbols_table const &) const;
   void enqueue_block(driver::CommandQueue & queue, int_t M, int_t N, int_t K, const expression_tree::node &A, const expression_tree::node &B, const expression_tree::node &C,
                      value_scalar const &alpha, value_scalar const &beta, driver::Program const & program, std::string const & suffix, runtime::execution_options_type const & options);
@@ -64,6 +65,7 @@ public:
   std::vector<int_t> input_sizes(expression_tree const & expressions) const;
   void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const & h);
   expression_type type() const;
+  std::vector<int> parameters() const;
 
 private:
   //Parameters
@@ -32,6 +32,7 @@ namespace templates
 class reduce_1d : public parameterized_base
 {
 private:
+  int is_implausible_impl(driver::Device const &, expression_tree const &) const;
   unsigned int lmem_usage(expression_tree const  & expressions) const;
   unsigned int temporary_workspace(expression_tree const & expressions) const;
   inline void reduce_1d_local_memory(kernel_generation_stream & stream, unsigned int size, std::vector<symbolic::reduce_1d*> exprs,
@@ -43,6 +44,7 @@ public:
   std::vector<int_t> input_sizes(expression_tree const  & expressions) const;
   void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const &);
   expression_type type() const;
+  std::vector<int> parameters() const;
 
 private:
   unsigned int ng_;
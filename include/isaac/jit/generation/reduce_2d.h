@@ -37,6 +37,7 @@ class reduce_2d : public parameterized_base
 protected:
   reduce_2d(unsigned int vwidth, unsigned int ls0, unsigned int ls1, unsigned int ng0, unsigned int ng1, operation_type_family);
 private:
+  int is_implausible_impl(driver::Device const &, expression_tree const &) const;
   unsigned int lmem_usage(expression_tree const &) const;
   unsigned int temporary_workspace(expression_tree const & expressions) const;
   std::string generate_impl(std::string const & suffix, expression_tree const &, driver::Device const & device, symbolic::symbols_table const &) const;
@@ -44,6 +45,7 @@ public:
   virtual std::vector<int_t> input_sizes(expression_tree const & expressions) const;
   void enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const &);
   expression_type type() const;
+  std::vector<int> parameters() const;
 private:
   unsigned int ng0_;
   unsigned int ng1_;
@@ -15,19 +15,31 @@ namespace symbolic
 {
 
 //Traverse
+//Nodes shared by several operators are only visited once
 template<class FUN>
 inline void traverse(expression_tree const & tree, size_t root, FUN const & fun,
-                     std::function<bool(size_t)> const & recurse)
+                     std::function<bool(size_t)> const & recurse, std::vector<bool> & visited)
 {
+  if(visited[root])
+    return;
+  visited[root] = true;
   expression_tree::node const & node = tree[root];
   if (node.type==COMPOSITE_OPERATOR_TYPE && recurse(root)){
-    traverse(tree, node.binary_operator.lhs, fun, recurse);
-    traverse(tree, node.binary_operator.rhs, fun, recurse);
+    traverse(tree, node.binary_operator.lhs, fun, recurse, visited);
+    traverse(tree, node.binary_operator.rhs, fun, recurse, visited);
   }
   if (node.type != INVALID_SUBTYPE)
     fun(root);
 }
 
+template<class FUN>
+inline void traverse(expression_tree const & tree, size_t root, FUN const & fun,
+                     std::function<bool(size_t)> const & recurse)
+{
+  std::vector<bool> visited(tree.data().size(), false);
+  traverse(tree, root, fun, recurse, visited);
+}
+
 template<class FUN>
 inline void traverse(expression_tree const & tree, size_t root, FUN const & fun)
 { return traverse(tree, root, fun,  [](size_t){return true;}); }
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_CALIBRATION_H
+#define ISAAC_RUNTIME_CALIBRATION_H
+
+#include <map>
+#include <mutex>
+
+#include "isaac/defines.h"
+#include "isaac/driver/command_queue.h"
+#include "isaac/driver/device.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Throughput figures of a device */
+struct ISAACAPI fingerprint
+{
+  fingerprint(double _bandwidth = 0, double _flops = 0, double _local_bandwidth = 0, double _launch = 0);
+  /** @brief Distance between the balances of two devices, which does not depend on their size */
+  double distance(fingerprint const & other) const;
+
+  double bandwidth;       //global memory, bytes per second
+  double flops;           //single-precision, floating-point operations per second
+  double local_bandwidth; //local memory, bytes per second
+  double launch;          //seconds per kernel launch
+};
+
+/** @brief Micro-benchmarks run once per device, to relate unknown hardware to the devices of the database */
+class ISAACAPI calibration
+{
+public:
+  /** @brief Runs the probes on a queue. This takes a few tens of milliseconds */
+  static fingerprint measure(driver::CommandQueue & queue);
+  /** @brief Fingerprint of the device of a queue, measured on first use. The planner uses the measured figures from then on */
+  static fingerprint const & get(driver::CommandQueue & queue);
+private:
+DISABLE_MSVC_WARNING_C4251
+  static std::map<driver::Device, fingerprint> cache_;
+  static std::mutex mutex_;
+RESTORE_MSVC_WARNING_C4251
+};
+
+}
+}
+
+#endif
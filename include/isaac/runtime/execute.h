@@ -22,8 +22,9 @@
 #ifndef _ISAAC_SYMBOLIC_EXECUTE_H
 #define _ISAAC_SYMBOLIC_EXECUTE_H
 
+#include <mutex>
+
 #include "isaac/runtime/profiles.h"
-#include "isaac/runtime/execute.h"
 
 namespace isaac
 {
@@ -35,8 +36,12 @@ namespace detail
   typedef std::vector<std::pair<size_t, expression_type> > breakpoints_t;
   expression_type parse(expression_tree const & tree, breakpoints_t & bp);
   expression_type parse(expression_tree const & tree, size_t idx, breakpoints_t & bp);
+  void optimize(expression_tree & tree);
 }
 
+/** @brief Executions share the profiles and program caches of their context, and hold the lock of that context. So do the calls that modify them */
+std::recursive_mutex & execution_mutex(driver::Context const & context);
+
 /** @brief Executes a expression_tree on the given queue for the given models map*/
 void execute(execution_handler const & , profiles::map_type &);
 
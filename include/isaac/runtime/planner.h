@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_PLANNER_H
+#define ISAAC_RUNTIME_PLANNER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "isaac/defines.h"
+#include "isaac/driver/device.h"
+#include "isaac/common/expression_type.h"
+#include "isaac/jit/syntax/expression/expression.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Coarse throughput figures used to predict the execution time of a kernel */
+struct ISAACAPI device_costs
+{
+  device_costs(double _bandwidth = 0, double _flops = 0, double _launch = 0);
+  static device_costs estimate(driver::Device const & device);
+
+  double bandwidth; //bytes per second
+  double flops;     //floating-point operations per second
+  double launch;    //seconds per kernel launch
+};
+
+/** @brief Sequence of kernels chosen to evaluate an expression tree */
+struct ISAACAPI execution_plan
+{
+  struct step
+  {
+    size_t node;
+    expression_type type;
+    bool mandatory;
+    double bytes;
+    double flops;
+    double time;
+  };
+
+  double time() const;
+
+  std::vector<step> temporaries;
+  step final;
+};
+
+class ISAACAPI planner
+{
+public:
+  static execution_plan make(expression_tree const & tree, device_costs const & costs);
+  static execution_plan make(expression_tree const & tree);
+  static device_costs costs(driver::Device const & device);
+  static void set_costs(driver::Device const & device, device_costs const & costs);
+  /** @brief Estimated registers of a work-item, from the bytes of private memory it uses */
+  static size_t registers(size_t private_bytes);
+  /** @brief Work-items a compute unit of a GPU keeps resident, limited by its register file, its local memory and its scheduler */
+  static size_t resident_work_items(driver::Device const & device, size_t group_size, size_t private_bytes, size_t local_bytes);
+public:
+  //Register file and residency limits common to recent GPUs
+  static const size_t MAX_REGISTERS_PER_WORK_ITEM = 255;
+  static const size_t REGISTERS_PER_COMPUTE_UNIT = 65536;
+  static const size_t MAX_WORK_ITEMS_PER_COMPUTE_UNIT = 2048;
+  static const size_t ADDRESSING_REGISTERS = 16;
+private:
+DISABLE_MSVC_WARNING_C4251
+  static std::map<driver::Device, device_costs> costs_;
+  static std::mutex mutex_;
+RESTORE_MSVC_WARNING_C4251
+};
+
+ISAACAPI std::string to_string(execution_plan const & plan);
+
+}
+}
+
+#endif
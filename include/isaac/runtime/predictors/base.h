@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#ifndef ISAAC_MODEL_PREDICTORS_BASE_H
+#define ISAAC_MODEL_PREDICTORS_BASE_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "isaac/types.h"
+
+namespace rapidjson{
+class CrtAllocator;
+template <typename BaseAllocator> class MemoryPoolAllocator;
+template <typename Encoding, typename Allocator> class GenericValue;
+template<typename CharType> struct UTF8;
+typedef GenericValue<UTF8<char>, MemoryPoolAllocator<CrtAllocator> > Value;
+}
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+/** @brief Performance of each template of a profile, as a function of the input sizes */
+class base
+{
+public:
+  virtual ~base(){}
+  virtual std::vector<float> predict(std::vector<int_t> const & x) const = 0;
+  /** @brief Name of the model, as in the "predictor_type" field of the profiles */
+  virtual std::string type() const = 0;
+  /** @brief Writes the JSON representation read by the constructor */
+  virtual void write(std::ostream & os) const = 0;
+};
+
+/** @brief Model of the given type: random_forest, nearest_neighbors or gradient_boosting */
+std::shared_ptr<base> create(std::string const & type, rapidjson::Value const & x);
+
+}
+}
+}
+
+#endif
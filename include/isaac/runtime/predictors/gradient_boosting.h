@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#ifndef ISAAC_MODEL_PREDICTORS_GRADIENT_BOOSTING_H
+#define ISAAC_MODEL_PREDICTORS_GRADIENT_BOOSTING_H
+
+#include <vector>
+#include "isaac/types.h"
+#include "isaac/runtime/predictors/base.h"
+#include "isaac/runtime/predictors/random_forest.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+/** @brief Sum of shallow regression trees, each fit on the residuals of the previous ones */
+class gradient_boosting : public base
+{
+public:
+  gradient_boosting(rapidjson::Value const & x);
+  gradient_boosting(std::vector<float> const & init, float learning_rate, std::vector<random_forest::tree> const & stages);
+  std::vector<float> predict(std::vector<int_t> const & x) const;
+  std::string type() const;
+  void write(std::ostream & os) const;
+private:
+  std::vector<float> init_;
+  float learning_rate_;
+  std::vector<random_forest::tree> stages_;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#ifndef ISAAC_MODEL_PREDICTORS_NEAREST_NEIGHBORS_H
+#define ISAAC_MODEL_PREDICTORS_NEAREST_NEIGHBORS_H
+
+#include <vector>
+#include "isaac/types.h"
+#include "isaac/runtime/predictors/base.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+/** @brief Inverse-distance weighted mean of the k closest measured shapes, on the logarithm of the sizes.
+ *  Unlike trees, it follows the shapes of the workload closely, such as skinny matrix products */
+class nearest_neighbors : public base
+{
+public:
+  nearest_neighbors(rapidjson::Value const & x);
+  /** @brief Values may be NAN for templates that were not measured */
+  nearest_neighbors(size_t k, std::vector<std::vector<int_t> > const & points, std::vector<std::vector<float> > const & values);
+  std::vector<float> predict(std::vector<int_t> const & x) const;
+  std::string type() const;
+  void write(std::ostream & os) const;
+private:
+  size_t k_;
+  std::vector<std::vector<int_t> > points_;
+  std::vector<std::vector<float> > values_;
+};
+
+}
+}
+}
+
+#endif
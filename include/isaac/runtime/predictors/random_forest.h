@@ -22,16 +22,10 @@
 #ifndef ISAAC_MODEL_PREDICTORS_RANDOM_FOREST_H
 #define ISAAC_MODEL_PREDICTORS_RANDOM_FOREST_H
 
+#include <ostream>
 #include <vector>
 #include "isaac/types.h"
-
-namespace rapidjson{
-class CrtAllocator;
-template <typename BaseAllocator> class MemoryPoolAllocator;
-template <typename Encoding, typename Allocator> class GenericValue;
-template<typename CharType> struct UTF8;
-typedef GenericValue<UTF8<char>, MemoryPoolAllocator<CrtAllocator> > Value;
-}
+#include "isaac/runtime/predictors/base.h"
 
 namespace isaac
 {
@@ -40,15 +34,20 @@ namespace runtime
 namespace predictors
 {
 
-class random_forest
+class random_forest : public base
 {
 public:
   class tree
   {
   public:
     tree(rapidjson::Value const & treerep);
+    /** @brief Nodes in the layout of scikit-learn: leaves have no children (-1) */
+    tree(std::vector<int> const & children_left, std::vector<int> const & children_right, std::vector<float> const & threshold,
+         std::vector<float> const & feature, std::vector<std::vector<float> > const & value);
     std::vector<float> const & predict(std::vector<int_t> const & x) const;
     size_t D() const;
+    /** @brief Writes the JSON representation read by the constructor */
+    void write(std::ostream & os) const;
   private:
     std::vector<int> children_left_;
     std::vector<int> children_right_;
@@ -59,8 +58,11 @@ public:
   };
 
   random_forest(rapidjson::Value const & estimators);
+  random_forest(std::vector<tree> const & estimators);
   std::vector<float> predict(std::vector<int_t> const & x) const;
   std::vector<tree> const & estimators() const;
+  std::string type() const;
+  void write(std::ostream & os) const;
 private:
   std::vector<tree> estimators_;
   size_t D_;
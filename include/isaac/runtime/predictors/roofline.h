@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_MODEL_PREDICTORS_ROOFLINE_H
+#define ISAAC_MODEL_PREDICTORS_ROOFLINE_H
+
+#include <memory>
+#include <vector>
+
+#include "isaac/driver/device.h"
+#include "isaac/jit/generation/base.h"
+#include "isaac/runtime/planner.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+/** @brief Analytic model for devices without a tuned profile.
+ *  Bounds each template by the peak throughput of the device (see planner::costs), corrected for
+ *  the reuse of its tiles, the balance of its work-groups across compute units and its occupancy */
+class roofline
+{
+public:
+  roofline(driver::Device const & device);
+  /** @brief Estimated execution time, in seconds. Infinite for templates the device can not run */
+  double predict(templates::base const & tp, expression_tree const & tree) const;
+  /** @brief Estimated performance of each template, as the inverse of its execution time */
+  std::vector<float> predict(std::vector<std::shared_ptr<templates::base> > const & templates, expression_tree const & tree) const;
+
+private:
+  double predict(templates::base const & tp, expression_tree const & tree, execution_plan::step const & kernel) const;
+
+private:
+  driver::Device device_;
+  device_costs costs_;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_MODEL_PREDICTORS_TRAINER_H
+#define ISAAC_MODEL_PREDICTORS_TRAINER_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "isaac/types.h"
+#include "isaac/runtime/predictors/base.h"
+#include "isaac/runtime/predictors/gradient_boosting.h"
+#include "isaac/runtime/predictors/nearest_neighbors.h"
+#include "isaac/runtime/predictors/random_forest.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+/** @brief Fits predictors on measurements: random forests of multi-output regression trees, like the offline tuner
+ *  does with scikit-learn, gradient-boosted trees and nearest neighbors. Rows hold the performance of each template for some input sizes. Templates that were not benchmarked are NAN:
+ *  they are imputed from a prior forest when there is one, and ignored by the splits otherwise */
+class trainer
+{
+public:
+  struct options_type
+  {
+    options_type(std::string const & _model = "random_forest", size_t _trees = 10, size_t _depth = 10, size_t _min_samples_leaf = 1,
+                 unsigned int _seed = 0, float _learning_rate = .3, size_t _neighbors = 5) :
+      model(_model), trees(_trees), depth(_depth), min_samples_leaf(_min_samples_leaf), seed(_seed), learning_rate(_learning_rate), neighbors(_neighbors){}
+    std::string model;    //type of the predictor, or "auto" to pick the one that ranks held-out rows best
+    size_t trees;         //of the forest, or stages of gradient boosting
+    size_t depth;
+    size_t min_samples_leaf;
+    unsigned int seed;
+    float learning_rate;  //of gradient boosting
+    size_t neighbors;
+  };
+
+private:
+  std::vector<float> mean(std::vector<size_t> const & samples, std::vector<float> const & fallback) const;
+  bool split(std::vector<size_t> const & samples, size_t & feature, float & threshold) const;
+  random_forest::tree grow(std::vector<size_t> const & samples, size_t depth) const;
+  void impute(base const * prior, bool normalize = true);
+  std::vector<random_forest::tree> grow();
+  gradient_boosting boost();
+  std::shared_ptr<base> fit(std::string const & model, base const * prior);
+  std::string select(base const * prior);
+
+public:
+  trainer(size_t D, options_type const & options = options_type());
+  /** @brief Adds the performance of each template for some input sizes. Missing templates are padded with NAN */
+  void add(std::vector<int_t> const & x, std::vector<float> const & y);
+  size_t size() const;
+  /** @brief New predictor fit on the rows */
+  std::shared_ptr<base> fit(base const * prior = NULL);
+  /** @brief Trees of a forest, followed by trees fit on the rows in the units of the forest */
+  random_forest extend(random_forest const & forest);
+
+private:
+  size_t D_;
+  options_type options_;
+  std::vector<std::vector<int_t> > X_;
+  std::vector<std::vector<float> > Y_;
+  std::vector<std::vector<float> > targets_;
+  mutable std::mt19937 generator_;
+};
+
+}
+}
+}
+
+#endif
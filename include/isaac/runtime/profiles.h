@@ -22,15 +22,21 @@
 #ifndef ISAAC_MODEL_DATABASE_H
 #define ISAAC_MODEL_DATABASE_H
 
+#include <chrono>
+#include <ctime>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "isaac/driver/command_queue.h"
 #include "isaac/driver/device.h"
 #include "isaac/common/expression_type.h"
 #include "isaac/common/numeric_type.h"
 #include "isaac/jit/generation/base.h"
-#include "isaac/runtime/predictors/random_forest.h"
+#include "isaac/runtime/calibration.h"
+#include "isaac/runtime/predictors/base.h"
+#include "isaac/runtime/predictors/trainer.h"
 #include "isaac/jit/syntax/expression/expression.h"
 
 namespace isaac
@@ -41,43 +47,122 @@ namespace runtime
 struct profiles
 {
     typedef std::map<std::tuple<driver::Device::Type, driver::Device::Vendor, driver::Device::Architecture> , const char *> presets_type;
+    typedef std::vector<std::tuple<driver::Device::Type, driver::Device::Vendor, fingerprint, const char *> > references_type;
 public:
+    /** @brief Templates requiring a larger temporary workspace are never benchmarked */
+    static const unsigned int MAX_TEMPORARY_WORKSPACE = 1000000;
+
     class value_type
     {
       typedef std::shared_ptr<templates::base> template_pointer;
       typedef std::vector<template_pointer> templates_container;
+      typedef std::map<std::string, std::future<driver::Program> > pending_type;
 
     private:
+      std::vector<float> predict(runtime::execution_handler const &);
       std::string define_extension(std::string const & extensions, std::string const & ext);
+      std::string program_name(runtime::execution_handler const &);
+      std::string generate(runtime::execution_handler const &);
+      std::string signature(runtime::execution_handler const &);
+      driver::Program const * find(runtime::execution_handler const &);
+      driver::Program const & add(runtime::execution_handler const &, driver::Program const &);
       driver::Program const & init(runtime::execution_handler const &);
+      driver::Program const & finish(runtime::execution_handler const &, pending_type::iterator);
+      bool execute_baseline(runtime::execution_handler const &);
 
     public:
-      value_type(expression_type, numeric_type, predictors::random_forest const &, std::vector< std::shared_ptr<templates::base> > const &, driver::CommandQueue const &);
+      value_type(expression_type, numeric_type, std::shared_ptr<predictors::base> const &, std::vector< std::shared_ptr<templates::base> > const &, driver::CommandQueue const &);
       value_type(numeric_type, std::shared_ptr<templates::base> const &, driver::CommandQueue const &);
+      /** @brief Copy of a profile. Builds in flight stay with the original */
+      value_type(value_type const & other);
+      /** @brief Copy of a profile with an additional template, which only labels select. Predictions ignore it */
+      value_type(value_type const & other, std::shared_ptr<templates::base> const & extra);
+      /** @brief Copy of a profile with another predictor */
+      value_type(value_type const & other, std::shared_ptr<predictors::base> const & predictor);
       void execute(runtime::execution_handler const &);
       templates_container const & templates() const;
+      /** @brief Templates chosen so far, by input sizes */
+      std::map<std::vector<int_t>, int> const & labels() const;
+      void set_label(std::vector<int_t> const & sizes, int label);
+      std::shared_ptr<predictors::base> const & predictor() const;
+      /** @brief Performance of each template benchmarked so far (the inverse of its time), by input sizes. NAN where not benchmarked */
+      std::map<std::vector<int_t>, std::vector<float> > const & measurements() const;
+      void record(std::vector<int_t> const & sizes, int label, double time);
+      double roofline() const;
+      /** @brief Weight of the roofline model against the predictor, between 0 and 1 */
+      void set_roofline(double weight);
+      /** @brief Tiered compilation: new expressions first run a single predicted template while the full program builds in the background */
+      static void set_tiered(bool enabled);
+
+    private:
+      void set_parameters();
 
     private:
       templates_container templates_;
-      std::shared_ptr<predictors::random_forest> predictor_;
+      //Types and parameters of the templates. Programs are named after them, so that reloaded profiles do not pick stale programs
+      std::string parameters_;
+      std::string tag_;
+      std::shared_ptr<predictors::base> predictor_;
+      double roofline_;
       std::map<std::vector<int_t>, int> labels_;
-      driver::CommandQueue queue_;
+      std::map<std::vector<int_t>, std::vector<float> > measurements_;
       driver::ProgramCache & cache_;
+      pending_type pending_;
+      static bool tiered_;
     };
 
     typedef std::map<std::pair<expression_type, numeric_type>, std::shared_ptr<value_type> > map_type;
-private:
+public:
     static std::shared_ptr<templates::base> create(std::string const & template_name, std::vector<int> const & x);
     static std::shared_ptr<templates::base> create(std::string const & op, std::string const & x);
-    static void import(std::string const & fname, driver::CommandQueue const & queue);
-    static map_type & init(driver::CommandQueue const & queue);
+private:
+    static void import(std::string const & fname, driver::CommandQueue const & queue, map_type & result);
+    static const char * nearest(driver::CommandQueue const & queue);
+    static std::shared_ptr<map_type> load(driver::CommandQueue const & queue);
+    static void poll(driver::CommandQueue const & queue);
 public:
     static void release();
-    static map_type & get(driver::CommandQueue const & queue);
+    /** @brief Drops the profiles of a context */
+    static void release(driver::Context const & context);
+    /** @brief Profiles of the context of a queue. They are shared by every queue of the context, and replaced as a whole on reload */
+    static std::shared_ptr<map_type> snapshot(driver::CommandQueue const & queue);
     static void set(driver::CommandQueue const & queue, expression_type operation, numeric_type dtype, std::shared_ptr<value_type> const & profile);
+    /** @brief Re-reads the presets and the user profile of a context. Executions in flight finish on the previous profiles */
+    static void reload(driver::CommandQueue const & queue);
+    /** @brief Reloads the profiles of a context, at most once per second, whenever the user profile changes on disk */
+    static void watch(bool enabled);
+    /** @brief Name of the user profile of a device, from its vendor, name, driver version and number of compute units */
+    static std::string identifier(driver::Device const & device);
+    /** @brief User profile of a device, in the profile directory */
+    static std::string path(driver::Device const & device);
+    /** @brief Directory of the user profiles; ISAAC_PROFILES_DIR, or ~/.isaac/devices by default */
+    static void set_directory(std::string const & directory);
+    /** @brief Writes the current profiles of a queue, with their labels. By default, to the user profile of its device */
+    static void save(driver::CommandQueue const & queue, std::string const & filename = "");
+    /** @brief Fits the predictor of an operation on the measurements of its profile. The current predictor fills the gaps,
+     *  and is either replaced or, for forests, extended with the new trees */
+    static void retrain(driver::CommandQueue const & queue, expression_type operation, numeric_type dtype,
+                        predictors::trainer::options_type const & options = predictors::trainer::options_type(), bool extend = false);
+    /** @brief Weight of the roofline model in the profiles loaded from then on, for operations without a profile tuned for the device */
+    static void set_roofline_weight(double weight);
+    /** @brief Devices without a preset use the preset of the closest known device, as measured by calibration probes.
+     *  On by default. The probes run once per device, on a private queue: a few tens of milliseconds, and two buffers of 32MB */
+    static void set_calibration(bool enabled);
 private:
+    struct source
+    {
+      std::time_t mtime;
+      std::chrono::steady_clock::time_point polled;
+    };
     static const presets_type presets_;
-    static std::map<driver::CommandQueue, map_type> cache_;
+    static const references_type references_;
+    static std::map<driver::Context, std::shared_ptr<map_type> > cache_;
+    static std::map<driver::Context, source> sources_;
+    static std::mutex mutex_;
+    static bool watch_;
+    static double roofline_weight_;
+    static bool calibration_;
+    static std::string directory_;
 };
 
 }
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_SUBMITTER_H
+#define ISAAC_RUNTIME_SUBMITTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "isaac/defines.h"
+#include "isaac/runtime/handler.h"
+#include "isaac/tools/cpp/ring.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Runs runtime::execute on a dedicated thread.
+ *
+ *  Application threads only push a copy of the execution handler into a lock-free ring; optimization, planning,
+ *  program lookup, argument binding and kernel enqueueing happen on the submission thread.
+ *  The returned future becomes ready once every kernel of the expression has been enqueued, and rethrows any error.
+ *  Until then, the arrays of the expression, as well as the events and dependencies of its execution options,
+ *  must stay alive and untouched. Commands from one thread run in the order they were submitted.
+ *  Other ISAAC calls may run meanwhile: executions hold the execution_mutex() of their context, so a synchronous one
+ *  waits at most for the expression being submitted.
+ */
+class ISAACAPI submitter
+{
+  struct command
+  {
+    std::function<void()> task; //empty for barriers
+    std::promise<void> promise;
+  };
+
+public:
+  submitter(size_t capacity = 1024);
+  ~submitter();
+  std::future<void> submit(execution_handler const & handler);
+  /** @brief Runs any other work on the submission thread, in order with the expressions */
+  std::future<void> submit(std::function<void()> const & task);
+  //Blocks until every command submitted so far has been processed
+  void synchronize();
+  static submitter & get();
+
+private:
+  std::future<void> push(command * cmd);
+  void run();
+
+private:
+DISABLE_MSVC_WARNING_C4251
+  tools::mpsc_ring<command*> ring_;
+  std::atomic<bool> sleeping_;
+  std::atomic<bool> stop_;
+  std::mutex mutex_;
+  std::condition_variable wakeup_;
+  std::thread thread_;
+RESTORE_MSVC_WARNING_C4251
+};
+
+/** @brief Executes a expression_tree on the default submission thread */
+ISAACAPI std::future<void> execute_async(execution_handler const &);
+
+}
+}
+
+#endif
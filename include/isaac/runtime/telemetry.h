@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_TELEMETRY_H
+#define ISAAC_RUNTIME_TELEMETRY_H
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "isaac/defines.h"
+#include "isaac/types.h"
+#include "isaac/common/expression_type.h"
+#include "isaac/common/numeric_type.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Quality of the template predictions, per operation, dtype and shape bucket.
+ *
+ *  Every autotuning records the order in which the predictions ranked the benchmarked templates, and their times.
+ *  The regret of a prediction is the time of its first choice over the best time measured, minus one.
+ *  Optionally, one cached execution out of a period is also timed (ISAAC_TELEMETRY_PERIOD).
+ *  With ISAAC_TELEMETRY_DUMP set, the statistics are written there as JSON when the program exits.
+ */
+class ISAACAPI telemetry
+{
+public:
+  /** @brief Input features rounded up to powers of two */
+  typedef std::tuple<expression_type, numeric_type, std::vector<int_t> > key_type;
+
+  struct entry
+  {
+    entry();
+    size_t tunings;
+    size_t hits;          //tunings where the first choice was the fastest
+    size_t failures;      //tunings where the first choice failed to run
+    double regret;        //sum over the tunings where the first choice ran
+    double max_regret;
+    size_t rank;          //sum of the positions of the fastest template in the predicted order
+    //Last tuning
+    std::vector<int> ranking;
+    std::vector<double> times;
+    //Cached executions, by template
+    std::map<int, std::pair<size_t, double> > samples;
+  };
+
+  static key_type key(expression_type operation, numeric_type dtype, std::vector<int_t> const & features);
+  /** @brief Templates in predicted order, and their times. Infinite times are templates that failed */
+  static void record(expression_type operation, numeric_type dtype, std::vector<int_t> const & features,
+                     std::vector<int> const & ranking, std::vector<double> const & times);
+  static void sample(expression_type operation, numeric_type dtype, std::vector<int_t> const & features, int label, double time);
+  /** @brief Whether the current cached execution should be timed */
+  static bool sampling();
+  /** @brief One cached execution out of period is timed. 0 disables sampling */
+  static void set_period(size_t period);
+
+  static std::map<key_type, entry> get();
+  static void clear();
+  /** @brief Writes the entries and a summary (hit rate, mean and worst regret) as JSON */
+  static void dump(std::string const & filename);
+
+private:
+DISABLE_MSVC_WARNING_C4251
+  static std::map<key_type, entry> entries_;
+  static std::mutex mutex_;
+  static std::atomic<size_t> period_;
+  static std::atomic<size_t> counter_;
+RESTORE_MSVC_WARNING_C4251
+};
+
+}
+}
+
+#endif
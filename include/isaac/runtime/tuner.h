@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_TUNER_H
+#define ISAAC_RUNTIME_TUNER_H
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "isaac/defines.h"
+#include "isaac/types.h"
+#include "isaac/common/expression_type.h"
+#include "isaac/common/numeric_type.h"
+#include "isaac/driver/command_queue.h"
+#include "isaac/jit/generation/base.h"
+#include "isaac/jit/syntax/expression/expression.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Budgeted genetic search over the parameters of a template, for the shape of one expression.
+ *
+ *  Parameters are powers of two, like in the offline tuner, and the search runs on their exponents.
+ *  The population is seeded with the templates of the current profile. Invalid and implausible candidates
+ *  are rejected before compilation and do not count against the budget.
+ */
+class ISAACAPI tuner
+{
+public:
+  struct options_type
+  {
+    options_type(size_t _budget = 64, double _seconds = 0, size_t _population = 16, unsigned int _seed = 0, bool _prefilter = true) :
+      budget(_budget), seconds(_seconds), population(_population), seed(_seed), prefilter(_prefilter){}
+    size_t budget;        //candidates compiled and benchmarked
+    double seconds;       //wall-clock limit of the search, when positive
+    size_t population;
+    unsigned int seed;
+    bool prefilter;       //skips implausible candidates; the search is redone without it when nothing is left
+  };
+
+  struct result_type
+  {
+    expression_type type;
+    numeric_type dtype;
+    std::vector<int_t> sizes;    //input features of the expression (see templates::base::input_features)
+    std::vector<int> parameters; //empty when no valid candidate was found
+    double time;
+    size_t evaluations;
+  };
+
+private:
+  typedef std::vector<int> genome_type;
+
+  static std::vector<int> const & bounds(expression_type type);
+  genome_type encode(std::vector<int> const & parameters, std::vector<int> const & bounds);
+  genome_type random(std::vector<int> const & bounds);
+  genome_type crossover(genome_type const & x, genome_type const & y);
+  genome_type mutate(genome_type x, std::vector<int> const & bounds);
+  double benchmark(templates::base & tp, expression_tree const & tree, driver::CommandQueue & queue);
+
+public:
+  tuner(options_type const & options = options_type());
+  /** @brief Searches parameters for an expression evaluated by a single kernel */
+  result_type run(expression_tree const & tree, driver::CommandQueue & queue);
+  /** @brief Adds the template found by run() to the profiles of the context of a queue, and labels the tuned shape with it */
+  static void apply(result_type const & result, driver::CommandQueue const & queue);
+
+private:
+  options_type options_;
+  std::mt19937 generator_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_RUNTIME_WARMUP_H
+#define ISAAC_RUNTIME_WARMUP_H
+
+#include <string>
+#include <vector>
+
+#include "isaac/defines.h"
+#include "isaac/types.h"
+#include "isaac/common/expression_type.h"
+#include "isaac/common/numeric_type.h"
+#include "isaac/driver/command_queue.h"
+#include "isaac/jit/syntax/expression/expression.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+/** @brief Compiles and tunes the given expressions ahead of time */
+ISAACAPI void warmup(std::vector<expression_tree> const & working_set, driver::CommandQueue & queue);
+
+/** @brief Compiles and tunes the BLAS form of each operation (axpy, dot, gemv, gemm...) for every dtype and shape.
+ *  Shapes are {N} for 1D operations, {M, N} for 2D operations and {M, N, K} for matrix products; shorter ones are skipped */
+ISAACAPI void warmup(std::vector<expression_type> const & operations, std::vector<numeric_type> const & dtypes,
+                     std::vector<std::vector<int_t> > const & shapes, driver::CommandQueue & queue);
+ISAACAPI void warmup(std::vector<expression_type> const & operations, std::vector<numeric_type> const & dtypes,
+                     std::vector<std::vector<int_t> > const & shapes);
+
+/** @brief Saves the compiled programs and the chosen templates of a queue into a single file.
+ *  Binaries are those of the first device of the context, and queues of other devices are rejected */
+ISAACAPI void export_bundle(std::string const & filename, driver::CommandQueue const & queue);
+
+/** @brief Loads a bundle produced by export_bundle on the same device, driver, library version and kernel generators */
+ISAACAPI void import_bundle(std::string const & filename, driver::CommandQueue const & queue);
+
+}
+}
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#ifndef ISAAC_TOOLS_CPP_RING_HPP
+#define ISAAC_TOOLS_CPP_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace isaac
+{
+namespace tools
+{
+
+/** @brief Bounded lock-free ring buffer for many producers and a single consumer.
+ *  Each cell carries a sequence number telling whose turn it is (after D. Vyukov's bounded queue) */
+template<class T>
+class mpsc_ring
+{
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+public:
+    //Capacity is rounded up to a power of two
+    explicit mpsc_ring(size_t capacity) : mask_(0), push_(0), pop_(0)
+    {
+        size_t size = 2;
+        while(size < capacity) size *= 2;
+        mask_ = size - 1;
+        cells_.reset(new cell[size]);
+        for(size_t i = 0 ; i < size ; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    //Returns false when the ring is full
+    bool push(T const & x)
+    {
+        size_t pos = push_.load(std::memory_order_relaxed);
+        cell * c;
+        while(true)
+        {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+            if(diff==0 && push_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+            if(diff < 0)
+                return false;
+            if(diff > 0)
+                pos = push_.load(std::memory_order_relaxed);
+        }
+        c->data = x;
+        c->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Returns false when the ring is empty. Must only be called from the consumer thread
+    bool pop(T & x)
+    {
+        size_t pos = pop_.load(std::memory_order_relaxed);
+        cell & c = cells_[pos & mask_];
+        if(c.sequence.load(std::memory_order_acquire) != pos + 1)
+            return false;
+        x = c.data;
+        c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        pop_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool empty() const
+    {
+        size_t pos = pop_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+private:
+    std::unique_ptr<cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> push_;
+    alignas(64) std::atomic<size_t> pop_;
+};
+
+}
+}
+
+#endif
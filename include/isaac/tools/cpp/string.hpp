@@ -22,6 +22,7 @@
 #ifndef ISAAC_TOOLS_CPP_STRING_HPP
 #define ISAAC_TOOLS_CPP_STRING_HPP
 
+#include <cctype>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -87,6 +88,16 @@ inline std::string join(T const & x, std::string const & delimiter)
   return join(x.begin(), x.end(), delimiter);
 }
 
+//JSON array of numbers
+template<class T>
+inline void write_array(std::ostream & os, std::vector<T> const & x)
+{
+  os << "[";
+  for(size_t i = 0 ; i < x.size() ; ++i)
+    os << (i?", ":"") << x[i];
+  os << "]";
+}
+
 //
 
 inline int find_and_replace(std::string & source, std::string const & find, std::string const & replace)
@@ -102,6 +113,33 @@ inline int find_and_replace(std::string & source, std::string const & find, std:
   return num;
 }
 
+/** @brief Replaces every prefix+key of source by the value of key, in a single pass.
+ *  Keys are made of [A-Za-z0-9_] and matched greedily; lookup returns NULL for unknown keys */
+template<class Lookup>
+inline std::string replace_keywords(std::string const & source, char prefix, Lookup const & lookup)
+{
+  std::string result;
+  result.reserve(source.size());
+  size_t pos = 0, next;
+  while((next = source.find(prefix, pos))!=std::string::npos)
+  {
+    result.append(source, pos, next - pos);
+    size_t end = next + 1;
+    while(end < source.size() && (std::isalnum((unsigned char)source[end]) || source[end]=='_'))
+      ++end;
+    std::string const * value = NULL;
+    size_t len = end - next - 1;
+    for(; len > 0 && !(value = lookup(source.substr(next + 1, len))) ; --len);
+    if(value)
+      result += *value;
+    else
+      result += prefix;
+    pos = next + 1 + len;
+  }
+  result.append(source, pos, std::string::npos);
+  return result;
+}
+
 //
 
 inline std::vector<std::string> tokenize(std::string const & str,std::string const & delimiters)
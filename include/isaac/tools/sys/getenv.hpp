@@ -23,7 +23,9 @@
 #define ISAAC_TOOLS_GETENV
 
 #include <string>
+#include <sstream>
 #include <cstdlib>
+#include <type_traits>
 
 namespace isaac
 {
@@ -49,6 +51,20 @@ namespace tools
         return result;
     }
 
+    //Numeric value of an environment variable, or the default when it is unset or malformed
+    template<class T>
+    inline T getenv(const char * name, T dflt)
+    {
+        std::string str = getenv(name);
+        if(std::is_unsigned<T>::value && str.find('-')!=std::string::npos)
+            return dflt;
+        std::istringstream iss(str);
+        T result;
+        if(!(iss >> result) || !(iss >> std::ws).eof())
+            return dflt;
+        return result;
+    }
+
 }
 
 }
@@ -50,8 +50,8 @@ extern "C"
         for(cl_uint i = 0 ; i < numCommandQueues ; ++i)
         {
             std::list<sc::driver::Event> levents;
-            sc::runtime::execution_options_type options(sc::driver::CommandQueue(commandQueues[i],false), &levents, &waitlist);
-            sc::runtime::execute(sc::runtime::execution_handler(operation, options), sc::runtime::profiles::get(options.queue(context)));
+            sc::runtime::execution_options_type options(sc::driver::backend::queues::import(commandQueues[i]), &levents, &waitlist);
+            sc::runtime::execute(sc::runtime::execution_handler(operation, options), *sc::runtime::profiles::snapshot(options.queue(context)));
             if(events)
             {
                 events[i] = levents.front().handle().cl();
@@ -22,11 +22,20 @@
 #include "isaac/driver/backend.h"
 #include "isaac/driver/buffer.h"
 #include "isaac/driver/context.h"
+#include "isaac/driver/device.h"
+#include "isaac/driver/platform.h"
 #include "isaac/driver/command_queue.h"
 #include "isaac/driver/kernel.h"
 #include "isaac/driver/program_cache.h"
 
+#include "isaac/tools/cpp/string.hpp"
+#include "isaac/tools/sys/getenv.hpp"
+
+#include "helpers/ocl/infos.hpp"
+
+#include <algorithm>
 #include <assert.h>
+#include <mutex>
 #include <stdexcept>
 #include <vector>
 
@@ -36,19 +45,41 @@ namespace isaac
 namespace driver
 {
 
+namespace
+{
+  //Executions on different contexts share the caches below
+  std::recursive_mutex & mutex()
+  {
+    static std::recursive_mutex result;
+    return result;
+  }
+}
+
 /*-----------------------------------*/
 //----------  Temporaries -----------*/
 /*-----------------------------------*/
 
 void backend::workspaces::release()
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     for(auto & x: cache_)
         delete x.second;
     cache_.clear();
 }
 
+void backend::workspaces::release(CommandQueue const & key)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    auto it = cache_.find(key);
+    if(it==cache_.end())
+        return;
+    delete it->second;
+    cache_.erase(it);
+}
+
 driver::Buffer & backend::workspaces::get(CommandQueue const & key)
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     if(cache_.find(key)==cache_.end())
         return *cache_.insert(std::make_pair(key, new Buffer(key.context(), SIZE))).first->second;
     return *cache_.at(key);
@@ -62,20 +93,68 @@ std::map<CommandQueue, Buffer * > backend::workspaces::cache_;
 
 void backend::programs::release()
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     for(auto & x: cache_)
         delete x.second;
     cache_.clear();
 }
 
-ProgramCache & backend::programs::get(CommandQueue const & queue, expression_type expression, numeric_type dtype)
+ProgramCache & backend::programs::get(Context const & context, expression_type expression, numeric_type dtype)
 {
-    std::tuple<CommandQueue, expression_type, numeric_type> key(queue, expression, dtype);
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    std::tuple<Context, expression_type, numeric_type> key(context, expression, dtype);
     if(cache_.find(key)==cache_.end())
-        return *cache_.insert(std::make_pair(key, new ProgramCache())).first->second;
+        return *cache_.insert(std::make_pair(key, new ProgramCache(capacity_))).first->second;
     return *cache_.at(key);
 }
 
-std::map<std::tuple<CommandQueue, expression_type, numeric_type>, ProgramCache * >  backend::programs::cache_;
+void backend::programs::trim(size_t n)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    for(auto & x: cache_)
+        x.second->trim(n);
+}
+
+void backend::programs::set_capacity(size_t capacity)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    capacity_ = capacity;
+    for(auto & x: cache_)
+        x.second->set_capacity(capacity);
+}
+
+backend::programs::statistics backend::programs::stats()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    statistics result{cache_.size(), 0, 0, 0, 0, 0};
+    for(auto & x: cache_)
+    {
+        ProgramCache::statistics const & stats = x.second->stats();
+        result.programs += stats.programs;
+        result.bytes += stats.bytes;
+        result.hits += stats.hits;
+        result.misses += stats.misses;
+        result.evictions += stats.evictions;
+    }
+    return result;
+}
+
+void backend::programs::release(Context const & context)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    for(auto it = cache_.begin() ; it != cache_.end() ;)
+        if(std::get<0>(it->first)==context)
+        {
+            it->second->clear();
+            delete it->second;
+            it = cache_.erase(it);
+        }
+        else
+            ++it;
+}
+
+std::map<std::tuple<Context, expression_type, numeric_type>, ProgramCache * >  backend::programs::cache_;
+size_t backend::programs::capacity_ = ProgramCache::DEFAULT_CAPACITY;
 
 /*-----------------------------------*/
 //-----------  Kernels --------------*/
@@ -83,13 +162,28 @@ std::map<std::tuple<CommandQueue, expression_type, numeric_type>, ProgramCache *
 
 void backend::kernels::release()
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     for(auto & x: cache_)
         delete x.second;
     cache_.clear();
 }
 
+void backend::kernels::release(Program const & program)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    for(auto it = cache_.begin() ; it != cache_.end() ;)
+        if(std::get<0>(it->first)==program)
+        {
+            delete it->second;
+            it = cache_.erase(it);
+        }
+        else
+            ++it;
+}
+
 Kernel & backend::kernels::get(Program const & program, std::string const & name)
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     std::tuple<Program, std::string> key(program, name);
     if(cache_.find(key)==cache_.end())
         return *cache_.insert(std::make_pair(key, new Kernel(program, name.c_str()))).first->second;
@@ -115,11 +209,41 @@ void backend::queues::release()
         for(auto & y: x.second)
             delete y;
     cache_.clear();
+    for(auto & x: foreign_)
+        delete x.second;
+    foreign_.clear();
+}
+
+//Drops the foreign queues that only we still reference, along with their workspace
+void backend::queues::sweep()
+{
+    for(auto it = foreign_.begin() ; it != foreign_.end() ;)
+        if(ocl::info<CL_QUEUE_REFERENCE_COUNT>(it->first)==1)
+        {
+            workspaces::release(*it->second);
+            delete it->second;
+            it = foreign_.erase(it);
+        }
+        else
+            ++it;
+}
+
+//Applications use few queues, so that sweeping on every import is cheap
+CommandQueue & backend::queues::import(cl_command_queue queue)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    backend::sweep();
+    auto it = foreign_.find(queue);
+    if(it!=foreign_.end())
+        return *it->second;
+    dispatch::clRetainCommandQueue(queue);
+    return *foreign_.insert(std::make_pair(queue, new CommandQueue(queue, true))).first->second;
 }
 
 
 CommandQueue & backend::queues::get(Context const & context, unsigned int id)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex());
   init(std::list<Context const *>(1,&context));
   for(auto & x : cache_)
     if(x.first==context)
@@ -129,11 +253,13 @@ CommandQueue & backend::queues::get(Context const & context, unsigned int id)
 
 void backend::queues::get(Context const & context, std::vector<CommandQueue*> & queues)
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     init(std::list<Context const *>(1,&context));
     queues = cache_.at(context);
 }
 
 std::map<Context, std::vector<CommandQueue*> > backend::queues::cache_;
+std::unordered_map<cl_command_queue, CommandQueue*> backend::queues::foreign_;
 
 /*-----------------------------------*/
 //------------  Contexts ------------*/
@@ -145,9 +271,9 @@ void backend::contexts::init(std::vector<Platform> const & platforms)
     {
         std::vector<Device> devices;
         platform.devices(devices);
-        for(Device const & device: devices)
-            cache_.push_back(new Context(device));
+        devices_.insert(devices_.end(), devices.begin(), devices.end());
     }
+    owned_.resize(devices_.size(), NULL);
 }
 
 void backend::contexts::release()
@@ -155,42 +281,88 @@ void backend::contexts::release()
     for(auto & x: cache_)
         delete x;
     cache_.clear();
+    cl_index_.clear();
+    cu_index_.clear();
+    owned_.clear();
+    devices_.clear();
 }
 
 Context const & backend::contexts::import(CUcontext context)
 {
-  for(driver::Context const * x: cache_)
-      if(x->handle().cu()==context)
-          return *x;
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  auto it = cu_index_.find(context);
+  if(it!=cu_index_.end())
+      return *it->second;
   cache_.emplace_back(new Context(context, false));
-  return *cache_.back();
+  return *(cu_index_[context] = cache_.back());
 }
 
 Context const & backend::contexts::import(cl_context context)
 {
-  for(driver::Context const * x: cache_)
-      if(x->handle().cl()==context)
-          return *x;
-  cache_.emplace_back(new Context(context, false));
-  return *cache_.back();
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  auto it = cl_index_.find(context);
+  if(it!=cl_index_.end())
+      return *it->second;
+  dispatch::clRetainContext(context);
+  cache_.emplace_back(new Context(context, true));
+  return *(cl_index_[context] = cache_.back());
+}
+
+void backend::contexts::on_release(std::function<void(Context const &)> const & callback)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  callbacks_.push_back(callback);
 }
 
 
 Context const & backend::contexts::get_default()
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  backend::init();
+  return get(devices_.at(default_device));
+}
+
+Context const & backend::contexts::get(Device const & device)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex());
   backend::init();
-  std::list<Context const *>::const_iterator it = cache_.begin();
-  std::advance(it, default_device);
-  return **it;
+  size_t i = std::distance(devices_.begin(), std::find(devices_.begin(), devices_.end(), device));
+  if(i==devices_.size())
+    throw std::invalid_argument("ISAAC: Device does not belong to the selected platforms");
+  if(!owned_[i])
+  {
+    owned_[i] = new Context(device);
+    cache_.push_back(owned_[i]);
+    if(owned_[i]->backend()==OPENCL)
+      cl_index_[owned_[i]->handle().cl()] = owned_[i];
+    else
+      cu_index_[owned_[i]->handle().cu()] = owned_[i];
+  }
+  return *owned_[i];
 }
 
 void backend::contexts::get(std::list<Context const *> & contexts)
 {
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  backend::init();
+  contexts.clear();
+  for(Device const & device: devices_)
+    contexts.push_back(&get(device));
+}
+
+void backend::contexts::devices(std::vector<Device> & devices)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex());
   backend::init();
-  contexts = cache_;
+  devices = devices_;
 }
 
+std::vector<Device> backend::contexts::devices_;
+std::vector<Context const *> backend::contexts::owned_;
 std::list<Context const *> backend::contexts::cache_;
+std::unordered_map<cl_context, Context const *> backend::contexts::cl_index_;
+std::unordered_map<CUcontext, Context const *> backend::contexts::cu_index_;
+std::vector<std::function<void(Context const &)> > backend::contexts::callbacks_;
 
 
 
@@ -198,12 +370,32 @@ std::list<Context const *> backend::contexts::cache_;
 //------------  General -------------*/
 /*-----------------------------------*/
 
+void backend::restrict_platforms(std::vector<std::string> const & names)
+{
+    if(!contexts::devices_.empty())
+        throw std::logic_error("ISAAC: Platforms must be restricted before any device is used");
+    platforms_filter_ = names;
+}
+
 void backend::platforms(std::vector<Platform> & platforms)
 {
     bool has_cuda = false;
+    auto selected = [](std::string name)
+    {
+        if(platforms_filter_.empty())
+            return true;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        for(std::string filter: platforms_filter_)
+        {
+            std::transform(filter.begin(), filter.end(), filter.begin(), ::tolower);
+            if(name.find(filter)!=std::string::npos)
+                return true;
+        }
+        return false;
+    };
 
-    //if cuda is here
-    if(dispatch::cuinit())
+    //if cuda is here. Its libraries are not even loaded when it is filtered out
+    if(selected("CUDA") && dispatch::cuinit())
     {
         if(dispatch::nvrtcinit()){
             platforms.push_back(Platform(CUDA));
@@ -224,23 +416,78 @@ void backend::platforms(std::vector<Platform> & platforms)
             Platform tmp(p);
             if(tmp.name().find("CUDA")!=std::string::npos && has_cuda)
                 continue;
+            if(!selected(tmp.name()))
+                continue;
             platforms.push_back(tmp);
         }
     }
 
+    if(platforms.empty() && !platforms_filter_.empty())
+        throw std::runtime_error("ISAAC: No platform matches the selection (ISAAC_PLATFORMS=" + tools::join(platforms_filter_, ",") + ")");
     if(platforms.empty())
         throw std::runtime_error("ISAAC: No backend available. Make sure OpenCL and/or CUDA are available in your library path");
 }
 
 void backend::synchronize(Context const & context)
 {
-    for(CommandQueue * queue: queues::cache_.at(context))
+    auto it = queues::cache_.find(context);
+    if(it==queues::cache_.end())
+        return;
+    for(CommandQueue * queue: it->second)
         queue->synchronize();
 }
 
 
+//Drops the foreign queues, then the foreign contexts that only we still reference, along with our queues, workspaces and programs on them
+void backend::sweep()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex());
+    queues::sweep();
+    for(auto it = contexts::cl_index_.begin() ; it != contexts::cl_index_.end() ;)
+    {
+        Context const * context = it->second;
+        if(std::find(contexts::owned_.begin(), contexts::owned_.end(), context)!=contexts::owned_.end())
+        {
+            ++it;
+            continue;
+        }
+        //Our references: the import, and the objects we created on the context
+        cl_uint references = 1;
+        auto queues = queues::cache_.find(*context);
+        if(queues!=queues::cache_.end())
+            references += (cl_uint)queues->second.size();
+        for(auto & x: workspaces::cache_)
+            if(x.first.context()==*context)
+                references++;
+        for(auto & x: programs::cache_)
+            if(std::get<0>(x.first)==*context)
+                references += (cl_uint)x.second->stats().programs;
+        if(ocl::info<CL_CONTEXT_REFERENCE_COUNT>(it->first)!=references)
+        {
+            ++it;
+            continue;
+        }
+        for(auto const & callback: contexts::callbacks_)
+            callback(*context);
+        programs::release(*context);
+        if(queues!=queues::cache_.end())
+        {
+            for(CommandQueue * queue: queues->second)
+            {
+                workspaces::release(*queue);
+                delete queue;
+            }
+            queues::cache_.erase(queues);
+        }
+        contexts::cache_.remove(context);
+        delete context;
+        it = contexts::cl_index_.erase(it);
+    }
+}
+
 void backend::release()
 {
+    std::lock_guard<std::recursive_mutex> lock(mutex());
     backend::kernels::release();
     backend::programs::release();
     backend::workspaces::release();
@@ -249,20 +496,23 @@ void backend::release()
 }
 
 
+//Only discovers devices; contexts and queues are created on first use
 void backend::init()
 {
-  if(!contexts::cache_.empty())
+  std::lock_guard<std::recursive_mutex> lock(mutex());
+  if(!contexts::devices_.empty())
       return;
   std::vector<Platform> platforms;
   backend::platforms(platforms);
   contexts::init(platforms);
-  queues::init(contexts::cache_);
 }
 
 unsigned int backend::default_device = 0;
 
 cl_command_queue_properties backend::default_queue_properties = 0;
 
+std::vector<std::string> backend::platforms_filter_ = tools::split(tools::getenv("ISAAC_PLATFORMS"), ',');
+
 
 }
 
@@ -59,17 +59,17 @@ std::string Context::cache_path()
 
 
 
-Context::Context(CUcontext const & context, bool take_ownership) : backend_(CUDA), device_(device(context), false), cache_path_(cache_path()), h_(backend_, take_ownership)
+Context::Context(CUcontext const & context, bool take_ownership) : backend_(CUDA), device_(device(context), false), h_(backend_, take_ownership)
 {
     h_.cu() = context;
 }
 
-Context::Context(cl_context const & context, bool take_ownership) : backend_(OPENCL), device_(ocl::info<CL_CONTEXT_DEVICES>(context)[0], false), cache_path_(cache_path()), h_(backend_, take_ownership)
+Context::Context(cl_context const & context, bool take_ownership) : backend_(OPENCL), device_(ocl::info<CL_CONTEXT_DEVICES>(context)[0], false), h_(backend_, take_ownership)
 {
     h_.cl() = context;
 }
 
-Context::Context(Device const & device) : backend_(device.backend_), device_(device), cache_path_(cache_path()), h_(backend_, true)
+Context::Context(Device const & device) : backend_(device.backend_), device_(device), h_(backend_, true)
 {
   switch(backend_)
   {
@@ -92,6 +92,24 @@ Context::handle_type const & Context::handle() const
 Device const & Context::device() const
 { return device_; }
 
+std::vector<Device> Context::devices() const
+{
+  std::vector<Device> result;
+  switch(backend_)
+  {
+    case CUDA:
+      result.push_back(device_);
+      break;
+    case OPENCL:
+      for(cl_device_id dev: ocl::info<CL_CONTEXT_DEVICES>(h_.cl()))
+        result.push_back(Device(dev, false));
+      break;
+    default:
+      throw;
+  }
+  return result;
+}
+
 backend_type Context::backend() const
 { return backend_; }
 
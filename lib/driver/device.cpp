@@ -22,7 +22,9 @@
 #include <algorithm>
 #include <sstream>
 #include <cstring>
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include "isaac/driver/device.h"
 #include "helpers/ocl/infos.hpp"
@@ -53,9 +55,8 @@ Device::Device(cl_device_id const & device, bool take_ownership) : backend_(OPEN
 }
 
 
-Device::Vendor Device::vendor() const
+Device::Vendor Device::query_vendor(std::string vname)
 {
-    std::string vname = vendor_str();
     std::transform(vname.begin(), vname.end(), vname.begin(), ::tolower);
     if(vname.find("nvidia")!=std::string::npos)
         return Vendor::NVIDIA;
@@ -68,9 +69,9 @@ Device::Vendor Device::vendor() const
 }
 
 
-Device::Architecture Device::architecture() const
+Device::Architecture Device::query_architecture(Vendor vendor, std::string const & device_name) const
 {
-    switch(vendor())
+    switch(vendor)
     {
         case Vendor::INTEL:
         {
@@ -119,7 +120,6 @@ Device::Architecture Device::architecture() const
         case Vendor::AMD:
         {
             //No simple way to query TeraScale/GCN version. Enumerate...
-            std::string device_name = name();
 
         #define MAP_DEVICE(device,arch)if (device_name.find(device,0)!=std::string::npos) return Architecture::arch;
             //TERASCALE 2
@@ -169,10 +169,13 @@ Device::Architecture Device::architecture() const
     }
 }
 
+Device::handle_type const & Device::handle() const
+{ return h_; }
+
 backend_type Device::backend() const
 { return backend_; }
 
-unsigned int Device::address_bits() const
+unsigned int Device::query_address_bits() const
 {
   switch(backend_)
   {
@@ -194,7 +197,7 @@ driver::Platform Device::platform() const
   }
 }
 
-std::string Device::name() const
+std::string Device::query_name() const
 {
   switch(backend_)
   {
@@ -208,7 +211,7 @@ std::string Device::name() const
   }
 }
 
-std::string Device::vendor_str() const
+std::string Device::query_vendor_str() const
 {
   switch(backend_)
   {
@@ -220,8 +223,20 @@ std::string Device::vendor_str() const
   }
 }
 
+std::string Device::driver_version() const
+{
+  switch(backend_)
+  {
+    case CUDA:
+      return platform().version();
+    case OPENCL:
+      return ocl::info<CL_DRIVER_VERSION>(h_.cl());
+    default: throw;
+  }
+}
 
-std::vector<size_t> Device::max_work_item_sizes() const
+
+std::vector<size_t> Device::query_max_work_item_sizes() const
 {
   switch(backend_)
   {
@@ -240,7 +255,7 @@ std::vector<size_t> Device::max_work_item_sizes() const
   }
 }
 
-Device::Type Device::type() const
+Device::Type Device::query_type() const
 {
   switch(backend_)
   {
@@ -250,7 +265,7 @@ Device::Type Device::type() const
   }
 }
 
-std::string Device::extensions() const
+std::string Device::query_extensions() const
 {
   switch(backend_)
   {
@@ -280,7 +295,7 @@ bool Device::fp64_support() const
   switch(backend_)
   {
     case OPENCL:
-      return extensions().find("cl_khr_fp64")!=std::string::npos;
+      return properties().extensions.find("cl_khr_fp64")!=std::string::npos;
     case CUDA:
       return true;
     default:
@@ -288,6 +303,16 @@ bool Device::fp64_support() const
   }
 }
 
+size_t Device::warp_wavefront_size() const
+{
+  switch(backend_)
+  {
+    case CUDA: return cuGetInfo<CU_DEVICE_ATTRIBUTE_WARP_SIZE>();
+    case OPENCL: return ocl::info<CL_DEVICE_WAVEFRONT_WIDTH_AMD>(h_.cl());
+    default: throw;
+  }
+}
+
 std::string Device::infos() const
 {
   std::ostringstream oss;
@@ -305,7 +330,7 @@ std::string Device::infos() const
 
 // Properties
 #define WRAP_ATTRIBUTE(ret, fname, CUNAME, CLNAME) \
-  ret Device::fname() const\
+  ret Device::query_##fname() const\
   {\
     switch(backend_)\
     {\
@@ -318,12 +343,85 @@ std::string Device::infos() const
 
 WRAP_ATTRIBUTE(size_t, max_work_group_size, CU_DEVICE_ATTRIBUTE_MAX_THREADS_PER_BLOCK, CL_DEVICE_MAX_WORK_GROUP_SIZE)
 WRAP_ATTRIBUTE(size_t, local_mem_size, CU_DEVICE_ATTRIBUTE_MAX_SHARED_MEMORY_PER_BLOCK, CL_DEVICE_LOCAL_MEM_SIZE)
-WRAP_ATTRIBUTE(size_t, warp_wavefront_size, CU_DEVICE_ATTRIBUTE_WARP_SIZE, CL_DEVICE_WAVEFRONT_WIDTH_AMD)
 WRAP_ATTRIBUTE(size_t, clock_rate, CU_DEVICE_ATTRIBUTE_CLOCK_RATE, CL_DEVICE_MAX_CLOCK_FREQUENCY)
+WRAP_ATTRIBUTE(size_t, compute_units, CU_DEVICE_ATTRIBUTE_MULTIPROCESSOR_COUNT, CL_DEVICE_MAX_COMPUTE_UNITS)
+
 
 
 
+//Properties never change, so they are queried once per physical device and shared by all its copies
+Device::properties_type const & Device::properties() const
+{
+  static std::map<std::pair<cl_device_id, CUdevice>, std::shared_ptr<properties_type const> > registry;
+  static std::mutex mutex;
+  //Copies of a device may be used from several threads. Only the first lookup of each copy takes the lock
+  std::shared_ptr<properties_type const> properties = std::atomic_load(&properties_);
+  if(!properties)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::pair<cl_device_id, CUdevice> key(backend_==OPENCL?h_.cl():NULL, backend_==CUDA?h_.cu():0);
+    std::shared_ptr<properties_type const> & result = registry[key];
+    if(!result)
+    {
+      std::shared_ptr<properties_type> tmp(new properties_type);
+      tmp->name = query_name();
+      tmp->vendor_str = query_vendor_str();
+      tmp->vendor = query_vendor(tmp->vendor_str);
+      tmp->architecture = query_architecture(tmp->vendor, tmp->name);
+      tmp->type = query_type();
+      tmp->extensions = query_extensions();
+      tmp->address_bits = query_address_bits();
+      tmp->clock_rate = query_clock_rate();
+      tmp->compute_units = query_compute_units();
+      tmp->max_work_group_size = query_max_work_group_size();
+      tmp->max_work_item_sizes = query_max_work_item_sizes();
+      tmp->local_mem_size = query_local_mem_size();
+      result = tmp;
+    }
+    properties = result;
+    std::atomic_store(&properties_, properties);
+  }
+  //The registry keeps the properties alive
+  return *properties;
 }
 
+Device::Vendor Device::vendor() const
+{ return properties().vendor; }
+
+Device::Architecture Device::architecture() const
+{ return properties().architecture; }
+
+std::string Device::name() const
+{ return properties().name; }
+
+std::string Device::vendor_str() const
+{ return properties().vendor_str; }
+
+Device::Type Device::type() const
+{ return properties().type; }
+
+std::string Device::extensions() const
+{ return properties().extensions; }
+
+unsigned int Device::address_bits() const
+{ return properties().address_bits; }
+
+size_t Device::clock_rate() const
+{ return properties().clock_rate; }
+
+size_t Device::compute_units() const
+{ return properties().compute_units; }
+
+size_t Device::max_work_group_size() const
+{ return properties().max_work_group_size; }
+
+std::vector<size_t> Device::max_work_item_sizes() const
+{ return properties().max_work_item_sizes; }
+
+size_t Device::local_mem_size() const
+{ return properties().local_mem_size; }
+
+
 }
 
+}
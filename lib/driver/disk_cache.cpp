@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <process.h>
+  #define ISAAC_GETPID _getpid
+#else
+  #include <unistd.h>
+  #define ISAAC_GETPID getpid
+#endif
+
+#include "isaac/driver/context.h"
+#include "isaac/driver/device.h"
+#include "isaac/driver/disk_cache.h"
+
+#include "tinysha1/sha1.hpp"
+
+#include "isaac/tools/cpp/string.hpp"
+#include "isaac/tools/sys/getenv.hpp"
+
+namespace isaac
+{
+
+namespace driver
+{
+
+namespace
+{
+  const char * INDEX = "index";
+  const char * INDEX_HEADER = "isaac-cache-1";
+}
+
+DiskCache::DiskCache(std::string const & path, uint64_t capacity) : path_(path), capacity_(capacity), clock_(0), dirty_(false), stats_{0, 0, 0, 0, 0}
+{
+  if(path_.size())
+    read_index();
+  for(auto const & x: index_)
+    stats_.size += x.second.size;
+}
+
+DiskCache::~DiskCache()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(dirty_)
+    sync();
+}
+
+std::string DiskCache::key(Device const & device, std::string const & source)
+{ return tools::sha1(device.name() + device.vendor_str() + device.platform().name() + device.driver_version() + source); }
+
+std::string DiskCache::fname(std::string const & key) const
+{ return path_ + key; }
+
+//Merges the index on disk into the one in memory, so that entries written by other processes are not lost
+void DiskCache::read_index()
+{
+  std::ifstream ifs(fname(INDEX));
+  std::string header;
+  if(!(ifs >> header) || header != INDEX_HEADER)
+    return;
+  std::string key;
+  entry e;
+  while(ifs >> key >> e.size >> e.last_use)
+  {
+    std::map<std::string, entry>::iterator it = index_.find(key);
+    if(it==index_.end())
+      index_.insert(std::make_pair(key, e));
+    else
+      it->second.last_use = std::max(it->second.last_use, e.last_use);
+    clock_ = std::max(clock_, e.last_use);
+  }
+}
+
+void DiskCache::write_index()
+{
+  std::ostringstream oss;
+  oss << INDEX_HEADER << std::endl;
+  for(auto const & x: index_)
+    oss << x.first << " " << x.second.size << " " << x.second.last_use << std::endl;
+  if(write_atomic(fname(INDEX), oss.str()))
+    dirty_ = false;
+}
+
+void DiskCache::sync()
+{
+  read_index();
+  evict();
+  write_index();
+}
+
+void DiskCache::evict()
+{
+  stats_.size = 0;
+  for(auto const & x: index_)
+    stats_.size += x.second.size;
+  if(stats_.size <= capacity_)
+    return;
+  std::vector<std::pair<uint64_t, std::string> > lru;
+  for(auto const & x: index_)
+    lru.push_back(std::make_pair(x.second.last_use, x.first));
+  std::sort(lru.begin(), lru.end());
+  for(size_t i = 0 ; i < lru.size() && stats_.size > capacity_ ; ++i)
+  {
+    std::remove(fname(lru[i].second).c_str());
+    stats_.size -= index_[lru[i].second].size;
+    index_.erase(lru[i].second);
+    stats_.evictions++;
+  }
+}
+
+bool DiskCache::write_atomic(std::string const & target, std::string const & data)
+{
+  static unsigned int counter = 0;
+  std::string tmp = target + ".tmp" + tools::to_string(ISAAC_GETPID()) + "_" + tools::to_string(counter++);
+  {
+    std::ofstream ofs(tmp, std::ios::binary);
+    if(!ofs.write(data.data(), std::streamsize(data.size())) || !ofs.flush())
+    {
+      ofs.close();
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+#if defined(_WIN32)
+  //rename() does not replace existing files on Windows
+  std::remove(target.c_str());
+#endif
+  if(std::rename(tmp.c_str(), target.c_str()) != 0)
+  {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool DiskCache::load(std::string const & key, std::string & binary)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ifstream ifs;
+  if(path_.size())
+    ifs.open(fname(key), std::ios::binary);
+  if(!ifs)
+  {
+    if(index_.erase(key))
+      dirty_ = true;
+    stats_.misses++;
+    return false;
+  }
+  binary.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  std::map<std::string, entry>::iterator it = index_.find(key);
+  //Entries never change once written, so a size mismatch means a corrupted file
+  if(binary.empty() || (it!=index_.end() && it->second.size != binary.size()))
+  {
+    ifs.close();
+    std::remove(fname(key).c_str());
+    index_.erase(key);
+    dirty_ = true;
+    stats_.misses++;
+    return false;
+  }
+  index_[key] = entry{binary.size(), ++clock_};
+  dirty_ = true;
+  stats_.hits++;
+  return true;
+}
+
+void DiskCache::store(std::string const & key, std::string const & binary)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(path_.empty() || binary.empty())
+    return;
+  if(!write_atomic(fname(key), binary))
+    return;
+  index_[key] = entry{binary.size(), ++clock_};
+  stats_.writes++;
+  sync();
+}
+
+void DiskCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if(path_.empty())
+    return;
+  read_index();
+  for(auto const & x: index_)
+    std::remove(fname(x.first).c_str());
+  index_.clear();
+  stats_.size = 0;
+  write_index();
+}
+
+std::string const & DiskCache::path() const
+{ return path_; }
+
+uint64_t DiskCache::capacity() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return capacity_;
+}
+
+void DiskCache::set_capacity(uint64_t capacity)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  if(path_.size())
+    sync();
+}
+
+DiskCache::statistics DiskCache::stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+DiskCache & DiskCache::get()
+{
+  static DiskCache result(Context::cache_path(), tools::getenv<uint64_t>("ISAAC_CACHE_SIZE", 256)*1024*1024);
+  return result;
+}
+
+}
+
+}
@@ -163,6 +163,8 @@ OCL_DEFINE5(cl_int, clGetEventProfilingInfo, cl_event, cl_profiling_info, size_t
 OCL_DEFINE7(cl_program, clCreateProgramWithBinary, cl_context, cl_uint, const cl_device_id *, const size_t *, const unsigned char **, cl_int *, cl_int *)
 OCL_DEFINE4(cl_command_queue, clCreateCommandQueue, cl_context, cl_device_id, cl_command_queue_properties, cl_int *)
 OCL_DEFINE1(cl_int, clRetainEvent, cl_event)
+OCL_DEFINE1(cl_int, clRetainCommandQueue, cl_command_queue)
+OCL_DEFINE1(cl_int, clRetainContext, cl_context)
 OCL_DEFINE1(cl_int, clReleaseProgram, cl_program)
 OCL_DEFINE1(cl_int, clFlush, cl_command_queue)
 OCL_DEFINE5(cl_int, clGetProgramInfo, cl_program, cl_program_info, size_t, void *, size_t *)
@@ -283,6 +285,8 @@ void* dispatch::clGetEventProfilingInfo_;
 void* dispatch::clCreateProgramWithBinary_;
 void* dispatch::clCreateCommandQueue_;
 void* dispatch::clRetainEvent_;
+void* dispatch::clRetainCommandQueue_;
+void* dispatch::clRetainContext_;
 void* dispatch::clReleaseProgram_;
 void* dispatch::clFlush_;
 void* dispatch::clGetProgramInfo_;
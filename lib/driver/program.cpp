@@ -21,17 +21,17 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 #include "isaac/driver/program.h"
 #include "isaac/driver/context.h"
+#include "isaac/driver/disk_cache.h"
 
 #include "isaac/exception/driver.h"
 
 #include "helpers/cuda/vector.hpp"
 #include "helpers/ocl/infos.hpp"
 
-#include "tinysha1/sha1.hpp"
-
 #include "isaac/tools/cpp/string.hpp"
 
 namespace isaac
@@ -40,22 +40,21 @@ namespace isaac
 namespace driver
 {
 
-Program::Program(Context const & context, std::string const & source) : backend_(context.backend_), context_(context), source_(source), h_(backend_, true)
+Program::Program(Context const & context, std::string const & source, bool use_cache) : backend_(context.backend_), context_(context), source_(source), h_(backend_, true)
 {
 //  std::cout << source << std::endl;
-  std::string cache_path = context.cache_path_;
+  DiskCache & cache = DiskCache::get();
+  //Binaries are still written back when bypassing the cache
   switch(backend_)
   {
     case CUDA:
     {
-      std::string prefix = context_.device_.name() + "cuda";
-      std::string sha1 = tools::sha1(prefix + source);
-      std::string fname(cache_path + sha1);
+      std::string key = DiskCache::key(context_.device_, "cuda" + source);
 
       //Load cached program
-      if(cache_path.size() && std::ifstream(fname, std::ios::binary))
+      if(use_cache && cache.load(key, ptx_))
       {
-        dispatch::cuModuleLoad(&h_.cu(), fname.c_str());
+        dispatch::cuModuleLoadDataEx(&h_.cu(), ptx_.data(), 0, NULL, NULL);
         break;
       }
 
@@ -86,13 +85,10 @@ Program::Program(Context const & context, std::string const & source) : backend_
       std::vector<char> ptx(ptx_size);
       dispatch::nvrtcGetPTX(prog, ptx.data());
       dispatch::cuModuleLoadDataEx(&h_.cu(), ptx.data(), 0, NULL, NULL);
+      ptx_.assign(ptx.begin(), ptx.end());
 
       //Save cached program
-      if (cache_path.size())
-      {
-        std::ofstream cached(fname.c_str(),std::ios::binary);
-        cached.write((char*)ptx.data(), std::streamsize(ptx_size));
-      }
+      cache.store(key, ptx_);
 
 //    std::ofstream oss(sha1 + ".cu", std::ofstream::out | std::ofstream::trunc);
 //    oss << source << std::endl;
@@ -121,25 +117,28 @@ Program::Program(Context const & context, std::string const & source) : backend_
       cl_int err;
       std::vector<cl_device_id> devices = ocl::info<CL_CONTEXT_DEVICES>(context_.h_.cl());
 
-      std::string prefix;
+      //One binary per device
+      std::vector<std::string> keys;
       for(cl_device_id dev: devices)
-        prefix += ocl::info<CL_DEVICE_NAME>(dev) + ocl::info<CL_DEVICE_VENDOR>(dev) + ocl::info<CL_DEVICE_VERSION>(dev);
-      std::string sha1 = tools::sha1(prefix + source);
-      std::string fname(cache_path + sha1);
+        keys.push_back(DiskCache::key(Device(dev, false), source));
       //Load cached program
       std::string build_opt;
-      if(cache_path.size())
+      if(use_cache)
       {
-        std::ifstream cached(fname, std::ios::binary);
-        if (cached)
+        std::vector<std::string> buffers(devices.size());
+        bool found = true;
+        for(size_t i = 0 ; i < devices.size() && found ; ++i)
+          found = cache.load(keys[i], buffers[i]);
+        if(found)
         {
-          std::size_t len;
-          std::vector<char> buffer;
-          cached.read((char*)&len, sizeof(std::size_t));
-          buffer.resize(len);
-          cached.read((char*)buffer.data(), std::streamsize(len));
-          char* cbuffer = buffer.data();
-          h_.cl() = dispatch::clCreateProgramWithBinary(context_.h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), &len, (const unsigned char **)&cbuffer, NULL, &err);
+          std::vector<size_t> lengths;
+          std::vector<const unsigned char*> cbuffers;
+          for(std::string const & buffer: buffers)
+          {
+            lengths.push_back(buffer.size());
+            cbuffers.push_back((const unsigned char*)buffer.data());
+          }
+          h_.cl() = dispatch::clCreateProgramWithBinary(context_.h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), lengths.data(), cbuffers.data(), NULL, &err);
           check(err);
           dispatch::clBuildProgram(h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), build_opt.c_str(), NULL, NULL);
           return;
@@ -152,16 +151,12 @@ Program::Program(Context const & context, std::string const & source) : backend_
       try{
         dispatch::clBuildProgram(h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), build_opt.c_str(), NULL, NULL);
         //Save cached program
-        if (cache_path.size())
-        {
-          std::ofstream cached(fname.c_str(),std::ios::binary);
-          std::vector<std::size_t> sizes = ocl::info<CL_PROGRAM_BINARY_SIZES>(h_.cl());
-          cached.write((char*)&sizes[0], sizeof(std::size_t));
-          std::vector<unsigned char*> binaries = ocl::info<CL_PROGRAM_BINARIES>(h_.cl());
-          cached.write((char*)binaries[0], std::streamsize(sizes[0]));
-          for(unsigned char * ptr: binaries)
-              delete[] ptr;
-        }
+        std::vector<std::size_t> sizes = ocl::info<CL_PROGRAM_BINARY_SIZES>(h_.cl());
+        std::vector<unsigned char*> binaries = ocl::info<CL_PROGRAM_BINARIES>(h_.cl());
+        for(size_t i = 0 ; i < binaries.size() ; ++i)
+          cache.store(keys[i], std::string((char*)binaries[i], sizes[i]));
+        for(unsigned char * ptr: binaries)
+            delete[] ptr;
       }catch(exception::ocl::build_program_failure const &){
             for(std::vector<cl_device_id>::const_iterator it = devices.begin(); it != devices.end(); ++it)
             {
@@ -179,6 +174,83 @@ Program::Program(Context const & context, std::string const & source) : backend_
   }
 }
 
+Program::Program(Context const & context) : backend_(context.backend_), context_(context), h_(backend_, true)
+{ }
+
+Program Program::load(Context const & context, std::vector<std::string> const & binaries)
+{
+  Program result(context);
+  switch(result.backend_)
+  {
+    case CUDA:
+      result.ptx_ = binaries.at(0);
+      dispatch::cuModuleLoadDataEx(&result.h_.cu(), result.ptx_.data(), 0, NULL, NULL);
+      break;
+    case OPENCL:
+    {
+      cl_int err;
+      std::vector<cl_device_id> devices = ocl::info<CL_CONTEXT_DEVICES>(context.h_.cl());
+      if(binaries.size()!=devices.size())
+        throw std::runtime_error("Program::load: one binary per device of the context is required");
+      std::vector<size_t> lengths;
+      std::vector<const unsigned char*> cbuffers;
+      for(std::string const & binary: binaries)
+      {
+        lengths.push_back(binary.size());
+        cbuffers.push_back((const unsigned char*)binary.data());
+      }
+      result.h_.cl() = dispatch::clCreateProgramWithBinary(context.h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), lengths.data(), cbuffers.data(), NULL, &err);
+      check(err);
+      dispatch::clBuildProgram(result.h_.cl(), static_cast<cl_uint>(devices.size()), devices.data(), "", NULL, NULL);
+      break;
+    }
+    default:
+      throw;
+  }
+  return result;
+}
+
+std::vector<std::string> Program::binaries() const
+{
+  switch(backend_)
+  {
+    case CUDA:
+      return std::vector<std::string>(1, ptx_);
+    case OPENCL:
+    {
+      std::vector<std::size_t> sizes = ocl::info<CL_PROGRAM_BINARY_SIZES>(h_.cl());
+      std::vector<unsigned char*> binaries = ocl::info<CL_PROGRAM_BINARIES>(h_.cl());
+      std::vector<std::string> result;
+      for(size_t i = 0 ; i < binaries.size() ; ++i)
+        result.push_back(std::string((char*)binaries[i], sizes[i]));
+      for(unsigned char * ptr: binaries)
+          delete[] ptr;
+      return result;
+    }
+    default:
+      throw;
+  }
+}
+
+size_t Program::binary_size() const
+{
+  switch(backend_)
+  {
+    case CUDA:
+      return ptx_.size();
+    case OPENCL:
+    {
+      std::vector<std::size_t> sizes = ocl::info<CL_PROGRAM_BINARY_SIZES>(h_.cl());
+      size_t result = 0;
+      for(size_t size: sizes)
+        result += size;
+      return result;
+    }
+    default:
+      throw;
+  }
+}
+
 Program::handle_type const & Program::handle() const
 { return h_; }
 
@@ -19,6 +19,7 @@
  * MA 02110-1301  USA
  */
 
+#include "isaac/driver/backend.h"
 #include "isaac/driver/program_cache.h"
 
 namespace isaac
@@ -27,34 +28,116 @@ namespace isaac
 namespace driver
 {
 
-Program & ProgramCache::add(Context const & context, std::string const & name, std::string const & src)
+ProgramCache::ProgramCache(size_t capacity) : capacity_(capacity), stats_{0, 0, 0, 0, 0}
+{ }
+
+Program & ProgramCache::insert(std::string const & name, Program const & program)
 {
-    std::map<std::string, Program>::iterator it = cache_.find(name);
-    if(it==cache_.end())
-    {
-        std::string extensions;
-        std::string ext = "cl_khr_fp64";
-        if(context.device().extensions().find(ext)!=std::string::npos)
-          extensions = "#pragma OPENCL EXTENSION " + ext + " : enable\n";
-        return cache_.insert(std::make_pair(name, driver::Program(context, extensions + src))).first->second;
-    }
-    return it->second;
+    //Keeps the program being added, so that references obtained from add() stay valid
+    trim(capacity_>0?capacity_-1:0);
+    lru_.push_front(name);
+    entry e{program, program.binary_size(), lru_.begin()};
+    stats_.programs++;
+    stats_.bytes += e.bytes;
+    return cache_.insert(std::make_pair(name, e)).first->second.program;
+}
+
+void ProgramCache::erase(std::map<std::string, entry>::iterator it)
+{
+    //Kernels must not outlive their module on CUDA
+    backend::kernels::release(it->second.program);
+    stats_.programs--;
+    stats_.bytes -= it->second.bytes;
+    lru_.erase(it->second.lru);
+    cache_.erase(it);
+}
+
+Program & ProgramCache::add(Context const & context, std::string const & name, std::string const & src, bool recompile)
+{
+    std::map<std::string, entry>::iterator it = cache_.find(name);
+    if(it!=cache_.end() && !recompile)
+        return it->second.program;
+    if(it!=cache_.end())
+        erase(it);
+    return insert(name, compile(context, src, !recompile));
+}
+
+Program & ProgramCache::add(std::string const & name, Program const & program)
+{
+    std::map<std::string, entry>::iterator it = cache_.find(name);
+    if(it!=cache_.end())
+        erase(it);
+    return insert(name, program);
+}
+
+Program ProgramCache::compile(Context const & context, std::string const & src, bool use_cache)
+{
+    std::string extensions;
+    std::string ext = "cl_khr_fp64";
+    if(context.device().extensions().find(ext)!=std::string::npos)
+      extensions = "#pragma OPENCL EXTENSION " + ext + " : enable\n";
+    return Program(context, extensions + src, use_cache);
 }
 
 Program const * ProgramCache::find(const std::string &name)
 {
-    std::map<std::string, Program>::const_iterator it = cache_.find(name);
+    std::map<std::string, entry>::iterator it = cache_.find(name);
     if(it==cache_.end())
+    {
+        stats_.misses++;
         return NULL;
-    return &(it->second);
+    }
+    stats_.hits++;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return &(it->second.program);
 }
 
-void ProgramCache::clear()
+void ProgramCache::erase(std::string const & name)
 {
-    cache_.clear();
+    std::map<std::string, entry>::iterator it = cache_.find(name);
+    if(it!=cache_.end())
+        erase(it);
 }
 
+std::map<std::string, Program> ProgramCache::programs() const
+{
+    std::map<std::string, Program> result;
+    for(auto const & x: cache_)
+        result.insert(std::make_pair(x.first, x.second.program));
+    return result;
 }
 
+void ProgramCache::trim(size_t n)
+{
+    while(cache_.size() > n)
+    {
+        erase(cache_.find(lru_.back()));
+        stats_.evictions++;
+    }
+}
+
+size_t ProgramCache::capacity() const
+{
+    return capacity_;
 }
 
+void ProgramCache::set_capacity(size_t capacity)
+{
+    capacity_ = capacity;
+    trim(capacity_);
+}
+
+ProgramCache::statistics const & ProgramCache::stats() const
+{
+    return stats_;
+}
+
+void ProgramCache::clear()
+{
+    while(!cache_.empty())
+        erase(cache_.begin());
+}
+
+}
+
+}
@@ -33,8 +33,14 @@
 #include "isaac/jit/generation/base.h"
 #include "isaac/exception/api.h"
 #include "isaac/jit/syntax/engine/process.h"
+#include "isaac/runtime/planner.h"
 #include "isaac/tools/cpp/string.hpp"
 
+//Hash of the generator sources, set by the build. Other builds are only known by their date
+#ifndef ISAAC_GENERATOR_ID
+#define ISAAC_GENERATOR_ID __DATE__ " " __TIME__
+#endif
+
 namespace isaac
 {
 namespace templates
@@ -43,15 +49,55 @@ namespace templates
 base::base()
 {}
 
+std::string base::generator_id()
+{ return ISAAC_GENERATOR_ID; }
+
 unsigned int base::lmem_usage(expression_tree const  &) const
 { return 0; }
 
 unsigned int base::registers_usage(expression_tree const  &) const
 { return 0; }
 
+std::vector<int> base::parameters() const
+{ return {}; }
+
 unsigned int base::temporary_workspace(expression_tree const  &) const
 { return 0; }
 
+namespace
+{
+  //Alignments beyond the widest vector access make no difference
+  int_t alignment(int_t x)
+  {
+    static const int_t MAX_ALIGNMENT = 16;
+    return (x==0)?MAX_ALIGNMENT:std::min(MAX_ALIGNMENT, x & -x);
+  }
+}
+
+std::vector<int_t> base::input_features(expression_tree const & expressions) const
+{
+  std::vector<int_t> result = input_sizes(expressions);
+  int_t operands = 0, stride = 1, padding = 0, ld_alignment = alignment(0), offset_alignment = alignment(0);
+  for(expression_tree::node const & node: expressions.data())
+  {
+    if(node.type!=DENSE_ARRAY_TYPE)
+      continue;
+    operands++;
+    stride = std::max(stride, node.ld[0]);
+    offset_alignment = std::min(offset_alignment, alignment(node.array.start));
+    if(node.shape.size() > 1 && node.shape[1] > 1)
+    {
+      padding = std::max(padding, node.ld[1] - node.shape[0]*node.ld[0]);
+      ld_alignment = std::min(ld_alignment, alignment(node.ld[1]));
+    }
+  }
+  result.insert(result.end(), {operands, stride, padding, ld_alignment, offset_alignment});
+  return result;
+}
+
+int base::is_implausible(expression_tree const &, driver::Device const &) const
+{ return TEMPLATE_VALID; }
+
 base::~base()
 { }
 
@@ -87,6 +133,18 @@ unsigned int external_base::registers_usage(expression_tree const &) const
 int parameterized_base::is_invalid_impl(driver::Device const &, expression_tree const  &) const
 { return TEMPLATE_VALID; }
 
+int parameterized_base::is_implausible_impl(driver::Device const &, expression_tree const  &) const
+{ return TEMPLATE_VALID; }
+
+int parameterized_base::check_work_groups(driver::Device const & device, size_t work_groups, size_t parallelism) const
+{
+  //Idle compute units, although smaller work-groups could have filled them
+  size_t units = device.compute_units();
+  if(work_groups < units && parallelism >= units*ls0_*ls1_)
+    return TEMPLATE_TOO_FEW_WORK_GROUPS;
+  return TEMPLATE_VALID;
+}
+
 parameterized_base::parameterized_base(unsigned int vwidth, int_t ls0, int_t ls1): vwidth_(vwidth), ls0_(ls0), ls1_(ls1)
 { }
 
@@ -122,6 +180,21 @@ int parameterized_base::is_invalid(expression_tree const  & expressions, driver:
   return is_invalid_impl(device, expressions);
 }
 
+int parameterized_base::is_implausible(expression_tree const & expressions, driver::Device const & device) const
+{
+  //Fewer resident work-items can not hide the latency of global memory
+  static const size_t MIN_RESIDENT_WORK_ITEMS = 128;
+  if(device.type()==driver::Device::Type::GPU)
+  {
+    size_t bytes = registers_usage(expressions);
+    if(runtime::planner::registers(bytes) > runtime::planner::MAX_REGISTERS_PER_WORK_ITEM)
+      return TEMPLATE_REGISTER_SPILL;
+    if(runtime::planner::resident_work_items(device, ls0_*ls1_, bytes, lmem_usage(expressions)) < MIN_RESIDENT_WORK_ITEMS)
+      return TEMPLATE_LOW_OCCUPANCY;
+  }
+  return is_implausible_impl(device, expressions);
+}
+
 std::shared_ptr<base> base::getptr()
 { return shared_from_this(); }
 
@@ -39,6 +39,9 @@ namespace templates
 expression_type elementwise_1d::type() const
 { return ELEMENTWISE_1D; }
 
+std::vector<int> elementwise_1d::parameters() const
+{ return {(int)vwidth_, (int)ls0_, (int)ng_}; }
+
 std::string elementwise_1d::generate_impl(std::string const & suffix, expression_tree const & tree, driver::Device const & device, symbolic::symbols_table const & symbols) const
 {
   driver::backend_type backend = device.backend();
@@ -110,6 +113,9 @@ elementwise_1d::elementwise_1d(unsigned int vwidth, unsigned int ls, unsigned in
     parameterized_base(vwidth,ls,1), ng_(ng)
 {}
 
+int elementwise_1d::is_implausible_impl(driver::Device const & device, expression_tree const & expressions) const
+{ return check_work_groups(device, ng_, input_sizes(expressions)[0]/vwidth_); }
+
 
 std::vector<int_t> elementwise_1d::input_sizes(expression_tree const & expressions) const
 {
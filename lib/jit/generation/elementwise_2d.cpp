@@ -43,6 +43,9 @@ int elementwise_2d::is_invalid_impl(driver::Device const &, expression_tree cons
 expression_type elementwise_2d::type() const
 { return ELEMENTWISE_2D; }
 
+std::vector<int> elementwise_2d::parameters() const
+{ return {(int)vwidth_, (int)ls0_, (int)ls1_, (int)ng0_, (int)ng1_}; }
+
 std::string elementwise_2d::generate_impl(std::string const & suffix, expression_tree const  & tree, driver::Device const & device, symbolic::symbols_table const & symbols) const
 {
   driver::backend_type backend = device.backend();
@@ -98,6 +101,12 @@ elementwise_2d::elementwise_2d(unsigned int vwidth, unsigned int ls0, unsigned i
     parameterized_base(vwidth, ls0, ls1), ng0_(ng0), ng1_(ng1)
 {}
 
+int elementwise_2d::is_implausible_impl(driver::Device const & device, expression_tree const & expression) const
+{
+  std::vector<int_t> MN = input_sizes(expression);
+  return check_work_groups(device, ng0_*ng1_, MN[0]*MN[1]);
+}
+
 std::vector<int_t> elementwise_2d::input_sizes(expression_tree const  & expression) const{
   return expression.shape();
 }
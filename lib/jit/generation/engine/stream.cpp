@@ -19,6 +19,8 @@
  * MA 02110-1301  USA
  */
 
+#include <map>
+
 #include "isaac/jit/generation/engine/stream.h"
 #include "isaac/tools/cpp/string.hpp"
 
@@ -43,48 +45,66 @@ int kernel_generation_stream::kgenstream::sync()
 kernel_generation_stream::kgenstream:: ~kgenstream()
 {  pubsync(); }
 
-void kernel_generation_stream::process(std::string& str)
+namespace
 {
 
-#define ADD_KEYWORD(NAME, OPENCL_NAME, CUDA_NAME) tools::find_and_replace(str, "$" + std::string(NAME), (backend_==driver::CUDA)?CUDA_NAME:OPENCL_NAME);
+typedef std::map<std::string, std::pair<std::string, std::string> > keywords_type;
 
+keywords_type const & keywords()
+{
+  static const keywords_type result = {
+    {"GLOBAL_IDX_0", {"get_global_id(0)", "(blockIdx.x*blockDim.x + threadIdx.x)"}},
+    {"GLOBAL_IDX_1", {"get_global_id(1)", "(blockIdx.y*blockDim.y + threadIdx.y)"}},
+    {"GLOBAL_IDX_2", {"get_global_id(2)", "(blockIdx.z*blockDim.z + threadIdx.z)"}},
 
-ADD_KEYWORD("GLOBAL_IDX_0", "get_global_id(0)", "(blockIdx.x*blockDim.x + threadIdx.x)")
-ADD_KEYWORD("GLOBAL_IDX_1", "get_global_id(1)", "(blockIdx.y*blockDim.y + threadIdx.y)")
-ADD_KEYWORD("GLOBAL_IDX_2", "get_global_id(2)", "(blockIdx.z*blockDim.z + threadIdx.z)")
+    {"GLOBAL_SIZE_0", {"get_global_size(0)", "(blockDim.x*gridDim.x)"}},
+    {"GLOBAL_SIZE_1", {"get_global_size(1)", "(blockDim.y*gridDim.y)"}},
+    {"GLOBAL_SIZE_2", {"get_global_size(2)", "(blockDim.z*gridDim.z)"}},
 
-ADD_KEYWORD("GLOBAL_SIZE_0", "get_global_size(0)", "(blockDim.x*gridDim.x)")
-ADD_KEYWORD("GLOBAL_SIZE_1", "get_global_size(1)", "(blockDim.y*gridDim.y)")
-ADD_KEYWORD("GLOBAL_SIZE_2", "get_global_size(2)", "(blockDim.z*gridDim.z)")
+    {"LOCAL_IDX_0", {"get_local_id(0)", "threadIdx.x"}},
+    {"LOCAL_IDX_1", {"get_local_id(1)", "threadIdx.y"}},
+    {"LOCAL_IDX_2", {"get_local_id(2)", "threadIdx.z"}},
 
-ADD_KEYWORD("LOCAL_IDX_0", "get_local_id(0)", "threadIdx.x")
-ADD_KEYWORD("LOCAL_IDX_1", "get_local_id(1)", "threadIdx.y")
-ADD_KEYWORD("LOCAL_IDX_2", "get_local_id(2)", "threadIdx.z")
+    {"LOCAL_SIZE_0", {"get_local_size(0)", "blockDim.x"}},
+    {"LOCAL_SIZE_1", {"get_local_size(1)", "blockDim.y"}},
+    {"LOCAL_SIZE_2", {"get_local_size(2)", "blockDim.z"}},
 
-ADD_KEYWORD("LOCAL_SIZE_0", "get_local_size(0)", "blockDim.x")
-ADD_KEYWORD("LOCAL_SIZE_1", "get_local_size(1)", "blockDim.y")
-ADD_KEYWORD("LOCAL_SIZE_2", "get_local_size(2)", "blockDim.z")
+    {"GROUP_IDX_0", {"get_group_id(0)", "blockIdx.x"}},
+    {"GROUP_IDX_1", {"get_group_id(1)", "blockIdx.y"}},
+    {"GROUP_IDX_2", {"get_group_id(2)", "blockIdx.z"}},
 
-ADD_KEYWORD("GROUP_IDX_0", "get_group_id(0)", "blockIdx.x")
-ADD_KEYWORD("GROUP_IDX_1", "get_group_id(1)", "blockIdx.y")
-ADD_KEYWORD("GROUP_IDX_2", "get_group_id(2)", "blockIdx.z")
+    {"GROUP_SIZE_0", {"get_ng(0)", "GridDim.x"}},
+    {"GROUP_SIZE_1", {"get_ng(1)", "GridDim.y"}},
+    {"GROUP_SIZE_2", {"get_ng(2)", "GridDim.z"}},
 
-ADD_KEYWORD("GROUP_SIZE_0", "get_ng(0)", "GridDim.x")
-ADD_KEYWORD("GROUP_SIZE_1", "get_ng(1)", "GridDim.y")
-ADD_KEYWORD("GROUP_SIZE_2", "get_ng(2)", "GridDim.z")
+    {"LOCAL_BARRIER", {"barrier(CLK_LOCAL_MEM_FENCE)", "__syncthreads()"}},
+    {"LOCAL_PTR", {"__local", ""}},
 
-ADD_KEYWORD("LOCAL_BARRIER", "barrier(CLK_LOCAL_MEM_FENCE)", "__syncthreads()")
-ADD_KEYWORD("LOCAL_PTR", "__local", "")
+    {"LOCAL", {"__local", "__shared__"}},
+    {"GLOBAL", {"__global", ""}},
 
-ADD_KEYWORD("LOCAL", "__local", "__shared__")
-ADD_KEYWORD("GLOBAL", "__global", "")
+    {"SIZE_T", {"int", "int"}},
+    {"KERNEL", {"__kernel", "extern \"C\" __global__"}},
 
-ADD_KEYWORD("SIZE_T", "int", "int")
-ADD_KEYWORD("KERNEL", "__kernel", "extern \"C\" __global__")
+    {"MAD", {"mad", "fma"}}
+  };
+  return result;
+}
 
-ADD_KEYWORD("MAD", "mad", "fma")
+}
 
-#undef ADD_KEYWORD
+//Keywords are substituted in a single pass; the longest matching keyword wins, so that e.g. $LOCAL_PTR is not read as $LOCAL
+void kernel_generation_stream::process(std::string& str)
+{
+  keywords_type const & table = keywords();
+  bool cuda = backend_==driver::CUDA;
+  str = tools::replace_keywords(str, '$', [&](std::string const & key) -> std::string const *
+  {
+    keywords_type::const_iterator it = table.find(key);
+    if(it==table.end())
+      return NULL;
+    return cuda?&it->second.second:&it->second.first;
+  });
 }
 
 kernel_generation_stream::kernel_generation_stream(driver::backend_type backend) : std::ostream(new kgenstream(oss,tab_count_)), tab_count_(0), backend_(backend)
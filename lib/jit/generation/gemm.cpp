@@ -25,6 +25,7 @@
 #include "isaac/jit/syntax/engine/process.h"
 #include "isaac/jit/generation/gemm.h"
 #include "isaac/jit/generation/engine/keywords.h"
+#include "isaac/runtime/planner.h"
 #include "isaac/exception/api.h"
 #include "tools/arguments.hpp"
 #include "tools/vector_types.hpp"
@@ -135,6 +136,9 @@ expression_type gemm::type() const
     return GEMM_TT;
 }
 
+std::vector<int> gemm::parameters() const
+{ return {(int)vwidth_, (int)ls0_, (int)kL_, (int)ls1_, (int)depth_, (int)mS_, (int)kS_, (int)nS_, (int)lf0_, (int)lf1_}; }
+
 
 unsigned int gemm::registers_usage(expression_tree const & expression) const
 {
@@ -192,6 +196,31 @@ int gemm::is_invalid_impl(driver::Device const &, expression_tree const &) const
   return TEMPLATE_VALID;
 }
 
+int gemm::is_implausible_impl(driver::Device const & device, expression_tree const & expressions) const
+{
+  symbolic::preset::gemm::args args;
+  std::vector<int_t> MNK = infos((expression_tree&)expressions, args, A_trans_);
+  int_t M = MNK[0], N = MNK[1], K = MNK[2];
+  if(M==0 || N==0 || K==0)
+    return TEMPLATE_VALID;
+  //Vector accesses to columns that do not start on a vector boundary
+  if(vwidth_ > 1)
+    for(expression_tree::node const * x: {args.A, args.B, args.C})
+      if(x->ld[1] % vwidth_ || x->array.start % vwidth_)
+        return TEMPLATE_MISALIGNED_SIMD_WIDTH;
+  int result = check_work_groups(device, ((M + mL_ - 1)/mL_)*((N + nL_ - 1)/nL_)*depth_, M*N);
+  if(result!=TEMPLATE_VALID)
+    return result;
+  //Each tile fetches (mL + nL)*kL elements for 2*mL*nL*kL flops. Far below the roofline ridge, the kernel starves
+  runtime::device_costs const & costs = runtime::planner::costs(device);
+  double size = size_of(expressions.dtype());
+  double tile = 2.*mL_*nL_/((mL_ + nL_)*size);
+  double problem = 2.*M*N*K/((M*K + K*N + M*N)*size);
+  if(tile < .25*std::min(problem, costs.flops/costs.bandwidth))
+    return TEMPLATE_LOW_ARITHMETIC_INTENSITY;
+  return TEMPLATE_VALID;
+}
+
 std::string gemm::generate_impl(std::string const & suffix, expression_tree const & tree, driver::Device const & device, symbolic::symbols_table const &) const
 {
   using std::string;
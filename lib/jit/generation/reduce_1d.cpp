@@ -51,6 +51,9 @@ unsigned int reduce_1d::temporary_workspace(expression_tree const &) const
 expression_type reduce_1d::type() const
 { return REDUCE_1D; }
 
+std::vector<int> reduce_1d::parameters() const
+{ return {(int)vwidth_, (int)ls0_, (int)ng_}; }
+
 inline void reduce_1d::reduce_1d_local_memory(kernel_generation_stream & stream, unsigned int size, std::vector<symbolic::reduce_1d*> exprs,
                                    std::string const & buf_str, std::string const & buf_value_str, driver::backend_type) const
 {
@@ -249,6 +252,9 @@ reduce_1d::reduce_1d(unsigned int vwidth, unsigned int ls, unsigned int ng):
     parameterized_base(vwidth,ls,1), ng_(ng)
 {}
 
+int reduce_1d::is_implausible_impl(driver::Device const & device, expression_tree const & x) const
+{ return check_work_groups(device, ng_, input_sizes(x)[0]/vwidth_); }
+
 std::vector<int_t> reduce_1d::input_sizes(expression_tree const  & x) const
 {
   std::vector<size_t> idx = symbolic::find(x, [](expression_tree::node const & x){return x.type==COMPOSITE_OPERATOR_TYPE && x.binary_operator.op.type_family==REDUCE;});
@@ -53,6 +53,12 @@ unsigned int reduce_2d::temporary_workspace(expression_tree const & expressions)
     return 0;
 }
 
+int reduce_2d::is_implausible_impl(driver::Device const & device, expression_tree const & expressions) const
+{
+  std::vector<int_t> MN = input_sizes(expressions);
+  return check_work_groups(device, ng0_*ng1_, MN[0]*MN[1]/vwidth_);
+}
+
 std::string reduce_2d::generate_impl(std::string const & suffix, expression_tree const & tree, driver::Device const & device, symbolic::symbols_table const & symbols) const
 {
   using tools::to_string;
@@ -291,6 +297,9 @@ expression_type reduce_2d::type() const
     return REDUCE_2D_COLS;
 }
 
+std::vector<int> reduce_2d::parameters() const
+{ return {(int)vwidth_, (int)ls0_, (int)ls1_, (int)ng0_, (int)ng1_}; }
+
 void reduce_2d::enqueue(driver::CommandQueue & queue, driver::Program const & program, std::string const & suffix, runtime::execution_handler const & control)
 {
   expression_tree const & tree = control.x();
@@ -85,9 +85,11 @@ std::string object::process(std::string const & in) const
       modified = modified || key.expand(res);
   }while(modified);
   //Attributes
-  for (auto const & key : attributes_)
-    tools::find_and_replace(res, "#" + key.first, key.second);
-  return res;
+  return tools::replace_keywords(res, '#', [&](std::string const & key) -> std::string const *
+  {
+    std::map<std::string, std::string>::const_iterator it = attributes_.find(key);
+    return it==attributes_.end()?NULL:&it->second;
+  });
 }
 
 bool object::hasattr(std::string const & name) const
@@ -69,30 +69,56 @@ std::string hash(expression_tree const & tree)
 {
   driver::backend_type backend = tree.context().backend();
 
-  char program_name[256];
-  char* ptr = program_name;
+  std::string result;
+  result.reserve(256);
+  //Arrays are bound as in symbolize(), so that trees which generate the same kernel share a name
   bind_independent binder(backend);
+  std::vector<size_t> assignee = lhs_of(tree, assignments(tree));
 
-  auto hash_impl = [&](size_t idx)
+  //Shared subtrees are hashed once, then referred to by their visit order,
+  //so that e.g. exp(x) - exp(x) cannot be confused with -exp(x)
+  std::vector<size_t> order(tree.data().size(), 0);
+  size_t visited = 0;
+
+  std::function<void(size_t)> hash_impl = [&](size_t idx)
   {
     expression_tree::node const & node = tree.data()[idx];
+    if(node.type==INVALID_SUBTYPE)
+      return;
+    if(order[idx])
+    {
+      result += "r" + tools::to_string(order[idx]) + '_';
+      return;
+    }
+    if(node.type==COMPOSITE_OPERATOR_TYPE)
+    {
+      hash_impl(node.binary_operator.lhs);
+      hash_impl(node.binary_operator.rhs);
+    }
+    order[idx] = ++visited;
+    for(size_t i = 0 ; i < node.shape.size() ; ++i)
+      result += node.shape[i]>1?'n':'1';
     if(node.type==DENSE_ARRAY_TYPE)
     {
-      for(size_t i = 0 ; i < node.shape.size() ; ++i)
-        *ptr++= node.shape[i]>1?'n':'1';
-      if(node.ld[0]>1) *ptr++= 's';
-      *ptr++=(char)node.dtype;
-      tools::fast_append(ptr, binder.get(node.array.handle, false));
+      bool is_assigned = std::find(assignee.begin(), assignee.end(), idx)!=assignee.end();
+      if(node.ld[0]>1) result += 's';
+      result += (char)('A' + node.dtype);
+      result += tools::to_string(binder.get(node.array.handle, is_assigned));
     }
+    else if(node.type==VALUE_SCALAR_TYPE)
+      result += (char)('a' + node.dtype);
     else if(node.type==COMPOSITE_OPERATOR_TYPE)
-      tools::fast_append(ptr,node.binary_operator.op.type);
+    {
+      op_element const & op = node.binary_operator.op;
+      result += "o" + tools::to_string((int)op.type_family) + "." + tools::to_string((int)op.type);
+    }
+    //Separator, so that consecutive numbers cannot be confused
+    result += '_';
   };
 
-  traverse(tree, hash_impl);
+  hash_impl(tree.root());
 
-  *ptr='\0';
-
-  return std::string(program_name);
+  return result;
 }
 
 //Set arguments
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "isaac/driver/buffer.h"
+#include "isaac/driver/kernel.h"
+#include "isaac/driver/program.h"
+#include "isaac/jit/generation/engine/stream.h"
+#include "isaac/runtime/calibration.h"
+#include "isaac/runtime/planner.h"
+#include "isaac/tools/cpp/timer.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+
+namespace
+{
+  const size_t COPY_SIZE = 1 << 23;         //floats per buffer, beyond the last-level cache of most devices
+  const size_t ITERATIONS = 4096;           //per work-item, in the arithmetic and local memory probes
+  const size_t WORK_ITEMS_PER_UNIT = 2048;
+  const size_t LAUNCHES = 64;
+
+  std::string source(driver::backend_type backend)
+  {
+    kernel_generation_stream stream(backend);
+    stream << "$KERNEL void probe_copy($SIZE_T N, $GLOBAL float* x, $GLOBAL float* y)" << std::endl;
+    stream << "{" << std::endl;
+    stream << "  for($SIZE_T i = $GLOBAL_IDX_0 ; i < N ; i += $GLOBAL_SIZE_0)" << std::endl;
+    stream << "    y[i] = x[i];" << std::endl;
+    stream << "}" << std::endl;
+    //Independent chains hide the latency of the arithmetic units
+    stream << "$KERNEL void probe_fma($SIZE_T N, float a, $GLOBAL float* y)" << std::endl;
+    stream << "{" << std::endl;
+    stream << "  float x0 = $LOCAL_IDX_0, x1 = x0 + 1, x2 = x0 + 2, x3 = x0 + 3, x4 = x0 + 4, x5 = x0 + 5, x6 = x0 + 6, x7 = x0 + 7;" << std::endl;
+    stream << "  for($SIZE_T i = 0 ; i < N ; ++i)" << std::endl;
+    stream << "  {" << std::endl;
+    for(unsigned int k = 0 ; k < 8 ; ++k)
+      stream << "    x" << k << " = $MAD(x" << k << ", a, a);" << std::endl;
+    stream << "  }" << std::endl;
+    stream << "  y[$GLOBAL_IDX_0] = x0 + x1 + x2 + x3 + x4 + x5 + x6 + x7;" << std::endl;
+    stream << "}" << std::endl;
+    stream << "$KERNEL void probe_local($SIZE_T N, $GLOBAL float* y)" << std::endl;
+    stream << "{" << std::endl;
+    stream << "  $LOCAL float buf[256];" << std::endl;
+    stream << "  $SIZE_T lid = $LOCAL_IDX_0;" << std::endl;
+    stream << "  for($SIZE_T j = lid ; j < 256 ; j += $LOCAL_SIZE_0)" << std::endl;
+    stream << "    buf[j] = j;" << std::endl;
+    stream << "  $LOCAL_BARRIER;" << std::endl;
+    stream << "  float acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;" << std::endl;
+    stream << "  for($SIZE_T i = 0 ; i < N ; i += 4)" << std::endl;
+    stream << "  {" << std::endl;
+    for(unsigned int k = 0 ; k < 4 ; ++k)
+      stream << "    acc" << k << " += buf[(lid + i + " << k << ") & 255];" << std::endl;
+    stream << "  }" << std::endl;
+    stream << "  y[$GLOBAL_IDX_0] = acc0 + acc1 + acc2 + acc3;" << std::endl;
+    stream << "}" << std::endl;
+    stream << "$KERNEL void probe_empty($GLOBAL float* y)" << std::endl;
+    stream << "{ }" << std::endl;
+    return stream.str();
+  }
+
+  //Best of a few runs, after a warm-up
+  double time(driver::CommandQueue & queue, driver::Kernel const & kernel, driver::NDRange global, driver::NDRange local)
+  {
+    queue.enqueue(kernel, global, local, NULL, NULL);
+    queue.synchronize();
+    double result = INFINITY;
+    for(unsigned int i = 0 ; i < 5 ; ++i)
+    {
+      tools::Timer tmr(true);
+      queue.enqueue(kernel, global, local, NULL, NULL);
+      queue.synchronize();
+      result = std::min(result, 1e-9*tmr.get().count());
+    }
+    return result;
+  }
+}
+
+fingerprint::fingerprint(double _bandwidth, double _flops, double _local_bandwidth, double _launch) :
+  bandwidth(_bandwidth), flops(_flops), local_bandwidth(_local_bandwidth), launch(_launch)
+{ }
+
+//Euclidean distance between the logarithms of the ratios
+double fingerprint::distance(fingerprint const & other) const
+{
+  double balance = std::log((flops/bandwidth)/(other.flops/other.bandwidth));
+  double local = std::log((local_bandwidth/flops)/(other.local_bandwidth/other.flops));
+  double latency = std::log(launch/other.launch);
+  return std::sqrt(balance*balance + local*local + latency*latency);
+}
+
+fingerprint calibration::measure(driver::CommandQueue & queue)
+{
+  driver::Context const & context = queue.context();
+  driver::Device const & device = context.device();
+  driver::Program program(context, source(context.backend()), false);
+  size_t local = std::min<size_t>(256, device.max_work_group_size());
+  size_t global = device.compute_units()*WORK_ITEMS_PER_UNIT;
+  driver::Buffer x(context, COPY_SIZE*sizeof(float)), y(context, COPY_SIZE*sizeof(float));
+  fingerprint result;
+  //Global memory
+  driver::Kernel copy(program, "probe_copy");
+  copy.setSizeArg(0, COPY_SIZE);
+  copy.setArg(1, x);
+  copy.setArg(2, y);
+  result.bandwidth = 2*COPY_SIZE*sizeof(float)/time(queue, copy, global, local);
+  //Arithmetic
+  driver::Kernel fma(program, "probe_fma");
+  fma.setSizeArg(0, ITERATIONS);
+  fma.setArg(1, .999f);
+  fma.setArg(2, y);
+  result.flops = 16.*ITERATIONS*global/time(queue, fma, global, local);
+  //Local memory
+  driver::Kernel shared(program, "probe_local");
+  shared.setSizeArg(0, ITERATIONS);
+  shared.setArg(1, y);
+  result.local_bandwidth = (double)ITERATIONS*global*sizeof(float)/time(queue, shared, global, local);
+  //Launch latency, for back-to-back kernels
+  driver::Kernel empty(program, "probe_empty");
+  empty.setArg(0, y);
+  queue.enqueue(empty, 1, 1, NULL, NULL);
+  queue.synchronize();
+  tools::Timer tmr(true);
+  for(size_t i = 0 ; i < LAUNCHES ; ++i)
+    queue.enqueue(empty, 1, 1, NULL, NULL);
+  queue.synchronize();
+  result.launch = 1e-9*tmr.get().count()/LAUNCHES;
+  return result;
+}
+
+//Several contexts may load their profiles concurrently. Entries are never overwritten, so references to them stay valid
+fingerprint const & calibration::get(driver::CommandQueue & queue)
+{
+  driver::Device const & device = queue.device();
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<driver::Device, fingerprint>::iterator it = cache_.find(device);
+  if(it==cache_.end())
+  {
+    it = cache_.insert(std::make_pair(device, measure(queue))).first;
+    planner::set_costs(device, device_costs(it->second.bandwidth, it->second.flops, it->second.launch));
+  }
+  return it->second;
+}
+
+std::map<driver::Device, fingerprint> calibration::cache_;
+std::mutex calibration::mutex_;
+
+}
+}
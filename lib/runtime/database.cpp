@@ -69,5 +69,20 @@ const profiles::presets_type profiles::presets_ =
 
 #undef DATABASE_ENTRY
 
+#define REFERENCE_ENTRY(TYPE, VENDOR, STRING, BANDWIDTH, FLOPS, LOCAL_BANDWIDTH, LAUNCH) \
+            std::make_tuple(driver::Device::Type::TYPE, driver::Device::Vendor::VENDOR, fingerprint(BANDWIDTH, FLOPS, LOCAL_BANDWIDTH, LAUNCH), STRING)
+
+//Nominal figures of a representative device of each preset. Probes fall short of them by a similar factor on every device
+const profiles::references_type profiles::references_ =
+{
+    REFERENCE_ENTRY(GPU, INTEL, database::intel::broadwell, 25.6e9, 384e9, 180e9, 20e-6),  //HD Graphics 5500
+    REFERENCE_ENTRY(GPU, NVIDIA, database::nvidia::sm_3_0, 192e9, 3.09e12, 1.0e12, 5e-6),  //GTX 680
+    REFERENCE_ENTRY(GPU, NVIDIA, database::nvidia::sm_5_2, 224e9, 4.98e12, 2.3e12, 4e-6),  //GTX 980
+    REFERENCE_ENTRY(GPU, NVIDIA, database::nvidia::sm_6_1, 320e9, 8.87e12, 4.3e12, 4e-6),  //GTX 1080
+    REFERENCE_ENTRY(GPU, AMD, database::amd::gcn_3, 512e9, 8.6e12, 8.6e12, 8e-6)           //R9 Fury X
+};
+
+#undef REFERENCE_ENTRY
+
 }
 }
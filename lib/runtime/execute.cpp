@@ -21,12 +21,15 @@
 
 #include <assert.h>
 #include <list>
+#include <map>
+#include <memory>
 #include <vector>
 #include <stdexcept>
 #include "isaac/types.h"
 #include "isaac/array.h"
 #include "isaac/runtime/profiles.h"
 #include "isaac/runtime/execute.h"
+#include "isaac/runtime/planner.h"
 #include "isaac/jit/syntax/expression/expression.h"
 #include "isaac/jit/syntax/expression/preset.h"
 
@@ -42,17 +45,6 @@ namespace runtime
       inline bool is_elementwise(expression_type type)
       { return type == ELEMENTWISE_1D || type == ELEMENTWISE_2D; }
 
-      /** @brief Optimizes the given expression tree */
-//      expression_type optimize(expression_type & tree, size_t idx)
-//      {
-//        expression_tree::node & node = tree[idx];
-//        if(node.type==COMPOSITE_OPERATOR_TYPE)
-//        {
-//          //Remove useless reshape
-//          if(node.binary_operator.op.type==RESHAPE)
-//        }
-//      }
-
       expression_type parse(expression_tree const & tree, breakpoints_t & bp){
         return parse(tree, tree.root(), bp);
       }
@@ -128,41 +120,45 @@ namespace runtime
   }
 
   /** @brief Executes a expression_tree on the given models map*/
+  //Keyed by handle rather than by context, so that the locks do not keep released contexts alive
+  std::recursive_mutex & execution_mutex(driver::Context const & context)
+  {
+    static std::map<std::pair<cl_context, CUcontext>, std::unique_ptr<std::recursive_mutex> > locks;
+    static std::mutex mutex;
+    std::pair<cl_context, CUcontext> key(context.backend()==driver::OPENCL?context.handle().cl():NULL, context.backend()==driver::CUDA?context.handle().cu():NULL);
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<std::recursive_mutex> & result = locks[key];
+    if(!result)
+      result.reset(new std::recursive_mutex());
+    return *result;
+  }
+
   void execute(execution_handler const & c, profiles::map_type & profiles)
   {
+    std::lock_guard<std::recursive_mutex> lock(execution_mutex(c.x().context()));
     typedef isaac::array array;
+    expression_tree tree = c.x();
     /*----Optimize----*/
-//    detail::optimize(tree);
+    detail::optimize(tree);
     /*----Process-----*/
-    expression_tree const & reftree = c.x();
-    driver::Context const & context = reftree.context();
-    size_t rootidx = reftree.root();
+    driver::Context const & context = tree.context();
+    size_t rootidx = tree.root();
     std::vector<std::shared_ptr<array> > temporaries;
-    expression_type final_type;
-    /*----Matrix Product-----*/
-    if(symbolic::preset::gemm::args args = symbolic::preset::gemm::check(reftree.data(), rootidx)){
-        final_type = args.type;
-    }
-    /*----Default-----*/
-    else
+    /*----Choose breakpoints-----*/
+    execution_plan plan = planner::make(tree);
+    /*----Compute required temporaries----*/
+    if(plan.temporaries.size())
     {
-        expression_tree tree = reftree;
+        //Labels and program names designate the final kernel only
+        dispatcher_options_type dispatcher_options(c.dispatcher_options().tune);
+        compilation_options_type compilation_options("", c.compilation_options().recompile);
         expression_tree::node & root = tree[rootidx];
         expression_tree::node & lhs = tree[root.binary_operator.lhs], &rhs = tree[root.binary_operator.rhs];
         expression_tree::node root_save = root, lhs_save = lhs, rhs_save = rhs;
-
-        detail::breakpoints_t breakpoints;
-        breakpoints.reserve(16);
-        /*----Parse required temporaries-----*/
-        final_type = detail::parse(tree, breakpoints);
-        std::set<size_t> found;
-        breakpoints.erase(std::remove_if(breakpoints.begin(), breakpoints.end(), [&](detail::breakpoints_t::value_type const & x){return !found.insert(x.first).second;}), breakpoints.end());
-        /*----Compute required temporaries----*/
-        for(auto current: breakpoints)
+        for(execution_plan::step const & current: plan.temporaries)
         {
-          expression_tree::node const & node = tree[current.first];
-          expression_type type = current.second;
-          std::shared_ptr<profiles::value_type> const & profile = profiles[std::make_pair(type, node.dtype)];
+          expression_tree::node const & node = tree[current.node];
+          std::shared_ptr<profiles::value_type> const & profile = profiles[std::make_pair(current.type, node.dtype)];
 
           //Create temporary
           std::shared_ptr<array> tmp = std::make_shared<array>(node.shape, node.dtype, context);
@@ -174,22 +170,22 @@ namespace runtime
           root.dtype = node.dtype;
           lhs = expression_tree::node(*tmp);
           rhs = node;
-          profile->execute(execution_handler(tree, c.execution_options(), c.dispatcher_options(), c.compilation_options()));
+          profile->execute(execution_handler(tree, c.execution_options(), dispatcher_options, compilation_options));
           //Update the expression tree
           root = root_save;
           lhs = lhs_save;
           rhs = rhs_save;
-          tree[current.first] = expression_tree::node(*tmp);
+          tree[current.node] = expression_tree::node(*tmp);
         }
     }
 
     /*-----Compute final expression-----*/
-    profiles[std::make_pair(final_type, reftree[rootidx].dtype)]->execute(execution_handler(reftree, c.execution_options(), c.dispatcher_options(), c.compilation_options()));
+    profiles[std::make_pair(plan.final.type, tree[rootidx].dtype)]->execute(execution_handler(tree, c.execution_options(), c.dispatcher_options(), c.compilation_options()));
   }
 
   void execute(execution_handler const & c)
   {
-    execute(c, profiles::get(c.execution_options().queue(c.x().context())));
+    execute(c, *profiles::snapshot(c.execution_options().queue(c.x().context())));
   }
 
 }
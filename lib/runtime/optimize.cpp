@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "isaac/runtime/execute.h"
+#include "isaac/jit/syntax/engine/process.h"
+#include "isaac/tools/cpp/string.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace detail
+{
+
+namespace
+{
+
+  typedef expression_tree::node node_t;
+
+  inline bool is_floating(numeric_type dtype)
+  { return dtype==FLOAT_TYPE || dtype==DOUBLE_TYPE; }
+
+  inline bool is_scalar(node_t const & x, double value)
+  { return x.type==VALUE_SCALAR_TYPE && (double)value_scalar(x.scalar, x.dtype)==value; }
+
+  inline bool is_op(node_t const & x, operation_type type)
+  { return x.type==COMPOSITE_OPERATOR_TYPE && x.binary_operator.op.type==type; }
+
+  inline bool is_product(node_t const & x)
+  { return is_op(x, MULT_TYPE) || is_op(x, ELEMENT_PROD_TYPE); }
+
+  inline bool is_negation(node_t const & x)
+  { return is_op(x, SUB_TYPE) && x.binary_operator.op.type_family==UNARY_ARITHMETIC; }
+
+  /** @brief Replaces the node at idx by the node at other, when it can be done without changing its type */
+  bool forward(expression_tree & tree, size_t idx, size_t other)
+  {
+    node_t const & x = tree[other];
+    if(x.dtype!=tree[idx].dtype || !(x.shape==tree[idx].shape))
+      return false;
+    tree[idx] = x;
+    return true;
+  }
+
+  /** @brief Evaluates an operator on host scalars. Returns false when it has no host equivalent */
+  template<class T>
+  bool evaluate(operation_type op, T x, T y, T & result)
+  {
+    switch(op)
+    {
+      case ADD_TYPE: result = x + y; return true;
+      case SUB_TYPE: result = x - y; return true;
+      case MULT_TYPE: case ELEMENT_PROD_TYPE: result = x*y; return true;
+      case DIV_TYPE: case ELEMENT_DIV_TYPE: if(!std::is_floating_point<T>::value && y==0) return false; result = x/y; return true;
+      case ELEMENT_MAX_TYPE: case ELEMENT_FMAX_TYPE: result = std::max(x, y); return true;
+      case ELEMENT_MIN_TYPE: case ELEMENT_FMIN_TYPE: result = std::min(x, y); return true;
+      case MINUS_TYPE: result = -x; return true;
+      default: return false;
+    }
+  }
+
+  inline bool evaluate_function(operation_type op, double x, double & result)
+  {
+    switch(op)
+    {
+      case ABS_TYPE: case FABS_TYPE: result = std::fabs(x); return true;
+      case SQRT_TYPE: result = std::sqrt(x); return true;
+      case EXP_TYPE: result = std::exp(x); return true;
+      case LOG_TYPE: result = std::log(x); return true;
+      default: return false;
+    }
+  }
+
+  /** @brief Folds an operator whose operands are all host scalars into a single host scalar */
+  bool fold(expression_tree & tree, size_t idx)
+  {
+    node_t & node = tree[idx];
+    op_element const & op = node.binary_operator.op;
+    node_t const & lhs = tree[node.binary_operator.lhs];
+    node_t const & rhs = tree[node.binary_operator.rhs];
+    if(op.type_family!=UNARY_ARITHMETIC && op.type_family!=BINARY_ARITHMETIC)
+      return false;
+    bool is_unary = op.type_family==UNARY_ARITHMETIC;
+    operation_type type = is_negation(node)?MINUS_TYPE:op.type;
+    if(node.dtype==INVALID_NUMERIC_TYPE || lhs.type!=VALUE_SCALAR_TYPE || (!is_unary && rhs.type!=VALUE_SCALAR_TYPE))
+      return false;
+    value_scalar x(lhs.scalar, lhs.dtype);
+    value_scalar y = is_unary?x:value_scalar(rhs.scalar, rhs.dtype);
+    value_scalar result(node.dtype);
+    if(is_cast(type))
+      result = cast(x, node.dtype);
+    else if(is_floating(node.dtype))
+    {
+      double tmp;
+      if(!evaluate<double>(type, x, y, tmp) && !(is_unary && evaluate_function(type, x, tmp)))
+        return false;
+      result = cast(value_scalar(tmp), node.dtype);
+    }
+    else
+    {
+      long long tmp;
+      if(!evaluate<long long>(type, x, y, tmp))
+        return false;
+      result = cast(value_scalar(tmp), node.dtype);
+    }
+    tuple shape = node.shape;
+    node = node_t(result);
+    node.shape = shape;
+    return true;
+  }
+
+  /** @brief Local rewrites, applied bottom-up */
+  void simplify(expression_tree & tree, size_t idx, std::vector<bool> & visited)
+  {
+    if(visited[idx])
+      return;
+    visited[idx] = true;
+    if(tree[idx].type!=COMPOSITE_OPERATOR_TYPE)
+      return;
+    simplify(tree, tree[idx].binary_operator.lhs, visited);
+    simplify(tree, tree[idx].binary_operator.rhs, visited);
+
+    node_t & node = tree[idx];
+    size_t lidx = node.binary_operator.lhs, ridx = node.binary_operator.rhs;
+    node_t & lhs = tree[lidx], & rhs = tree[ridx];
+    operation_type op = node.binary_operator.op.type;
+    //Constant folding
+    if(fold(tree, idx))
+      return;
+    //Reshapes that leave the shape unchanged
+    if(op==RESHAPE_TYPE && forward(tree, idx, lidx))
+      return;
+    //trans(trans(x)) = x, -(-x) = x
+    if(op==TRANS_TYPE && is_op(lhs, TRANS_TYPE) && forward(tree, idx, lhs.binary_operator.lhs))
+      return;
+    if(is_negation(node) && is_negation(lhs) && forward(tree, idx, lhs.binary_operator.lhs))
+      return;
+    //pow(x, 2) = x*x, pow(x, 1) = x
+    if(op==ELEMENT_POW_TYPE && is_scalar(rhs, 2) && lhs.shape==node.shape)
+    {
+      node.binary_operator.op = op_element(BINARY_ARITHMETIC, ELEMENT_PROD_TYPE);
+      node.binary_operator.rhs = lidx;
+      return;
+    }
+    if(op==ELEMENT_POW_TYPE && is_scalar(rhs, 1) && forward(tree, idx, lidx))
+      return;
+    //x*1 = x, x/1 = x, x+0 = x, x-0 = x
+    if((is_product(node) || op==DIV_TYPE || op==ELEMENT_DIV_TYPE) && is_scalar(rhs, 1) && forward(tree, idx, lidx))
+      return;
+    if((op==ADD_TYPE || op==SUB_TYPE) && !is_negation(node) && is_scalar(rhs, 0) && forward(tree, idx, lidx))
+      return;
+    if(is_product(node) && is_scalar(lhs, 1) && forward(tree, idx, ridx))
+      return;
+    if(op==ADD_TYPE && is_scalar(lhs, 0) && forward(tree, idx, ridx))
+      return;
+    //a*(b*x) = (a*b)*x
+    if(is_product(node))
+    {
+      size_t sidx = (lhs.type==VALUE_SCALAR_TYPE)?lidx:ridx;
+      size_t pidx = (sidx==lidx)?ridx:lidx;
+      node_t const & p = tree[pidx];
+      if(tree[sidx].type!=VALUE_SCALAR_TYPE || !is_product(p) || p.dtype!=node.dtype)
+        return;
+      size_t b = p.binary_operator.lhs, x = p.binary_operator.rhs;
+      if(tree[b].type!=VALUE_SCALAR_TYPE)
+        std::swap(b, x);
+      if(tree[b].type!=VALUE_SCALAR_TYPE || !(tree[x].shape==node.shape))
+        return;
+      //The inner product is only referenced here, so a*b can be evaluated in its place
+      node_t save = p;
+      tree[pidx] = node_t(sidx, op_element(BINARY_ARITHMETIC, MULT_TYPE), b, node.dtype, tree[sidx].shape);
+      if(!fold(tree, pidx))
+      {
+        tree[pidx] = save;
+        return;
+      }
+      node.binary_operator.lhs = pidx;
+      node.binary_operator.rhs = x;
+    }
+  }
+
+  inline bool is_commutative(node_t const & x)
+  {
+    if(x.type!=COMPOSITE_OPERATOR_TYPE || x.binary_operator.op.type_family!=BINARY_ARITHMETIC)
+      return false;
+    switch(x.binary_operator.op.type)
+    {
+      case ADD_TYPE: case MULT_TYPE: case ELEMENT_PROD_TYPE:
+      case ELEMENT_EQ_TYPE: case ELEMENT_NEQ_TYPE:
+      case ELEMENT_MAX_TYPE: case ELEMENT_MIN_TYPE: case ELEMENT_FMAX_TYPE: case ELEMENT_FMIN_TYPE:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /** @brief Orders the operands of commutative operators by structure, so that equivalent trees share a program.
+   *  Host scalars sort first, which keeps the alpha*PROD form recognized by the GEMM preset */
+  std::string const & canonicalize(expression_tree & tree, size_t idx, std::vector<std::string> & signature, std::vector<bool> & visited)
+  {
+    std::string & result = signature[idx];
+    if(visited[idx])
+      return result;
+    visited[idx] = true;
+    node_t & node = tree[idx];
+    switch(node.type)
+    {
+      case VALUE_SCALAR_TYPE: result = "0"; break;
+      case DENSE_ARRAY_TYPE: result = "1"; break;
+      case COMPOSITE_OPERATOR_TYPE: result = "2"; break;
+      default: result = "3";
+    }
+    result += tools::to_string((int)node.dtype);
+    for(int_t x: node.shape)
+      result += (x>1)?'n':'1';
+    if(node.type==COMPOSITE_OPERATOR_TYPE)
+    {
+      std::string const & lhs = canonicalize(tree, node.binary_operator.lhs, signature, visited);
+      std::string const & rhs = canonicalize(tree, node.binary_operator.rhs, signature, visited);
+      bool swap = is_commutative(node) && rhs < lhs;
+      if(swap)
+        std::swap(node.binary_operator.lhs, node.binary_operator.rhs);
+      result += tools::to_string((int)node.binary_operator.op.type) + "(" + (swap?rhs:lhs) + "," + (swap?lhs:rhs) + ")";
+    }
+    return result;
+  }
+
+  /** @brief Operators whose result only depends on their operands, and can therefore be shared */
+  inline bool is_pure(node_t const & x)
+  {
+    if(x.type!=COMPOSITE_OPERATOR_TYPE)
+      return false;
+    operation_type op = x.binary_operator.op.type;
+    return !is_assignment(op) && op!=PAIR_TYPE && op!=OPERATOR_FUSE && op!=SFOR_TYPE && op!=ACCESS_INDEX_TYPE;
+  }
+
+  template<class T>
+  inline void append(std::string & key, T const & x)
+  { key.append((char const *)&x, sizeof(T)); }
+
+  /** @brief Common subexpression elimination: structurally identical operators are merged into one node */
+  void eliminate(expression_tree & tree, size_t idx, std::map<std::string, size_t> & known, std::vector<long> & canonical)
+  {
+    if(canonical[idx]>=0)
+      return;
+    node_t & node = tree[idx];
+    std::string key;
+    append(key, node.type);
+    append(key, node.dtype);
+    append(key, node.shape.size());
+    for(int_t x: node.shape) append(key, x);
+    switch(node.type)
+    {
+      case COMPOSITE_OPERATOR_TYPE:
+      {
+        eliminate(tree, node.binary_operator.lhs, known, canonical);
+        eliminate(tree, node.binary_operator.rhs, known, canonical);
+        if(is_pure(tree[node.binary_operator.lhs])) node.binary_operator.lhs = canonical[node.binary_operator.lhs];
+        if(is_pure(tree[node.binary_operator.rhs])) node.binary_operator.rhs = canonical[node.binary_operator.rhs];
+        append(key, node.binary_operator.op.type_family);
+        append(key, node.binary_operator.op.type);
+        append(key, canonical[node.binary_operator.lhs]);
+        append(key, canonical[node.binary_operator.rhs]);
+        break;
+      }
+      case VALUE_SCALAR_TYPE:
+        key.append((char const *)&node.scalar, size_of(node.dtype));
+        break;
+      case DENSE_ARRAY_TYPE:
+        append(key, node.array.base);
+        append(key, node.array.start);
+        for(int_t x: node.ld) append(key, x);
+        break;
+      case INVALID_SUBTYPE:
+        break;
+      default:
+        //Never merged
+        append(key, idx);
+    }
+    canonical[idx] = known.insert(std::make_pair(key, idx)).first->second;
+  }
+
+}
+
+void optimize(expression_tree & tree)
+{
+  std::vector<bool> visited(tree.data().size(), false);
+  simplify(tree, tree.root(), visited);
+  std::vector<std::string> signature(tree.data().size());
+  visited.assign(tree.data().size(), false);
+  canonicalize(tree, tree.root(), signature, visited);
+  //Operands of distinct assignments may see different values
+  if(symbolic::assignments(tree).size() > 1)
+    return;
+  std::map<std::string, size_t> known;
+  std::vector<long> canonical(tree.data().size(), -1);
+  eliminate(tree, tree.root(), known, canonical);
+}
+
+}
+}
+}
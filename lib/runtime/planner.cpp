@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+#include "isaac/runtime/planner.h"
+#include "isaac/runtime/execute.h"
+#include "isaac/jit/syntax/engine/process.h"
+#include "isaac/jit/syntax/expression/preset.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+namespace detail
+{
+
+  struct kernel_stats
+  {
+    kernel_stats() : bytes(0), flops(0), space(0){}
+    double bytes;
+    double flops;
+    double space;
+  };
+
+  inline double numel(tuple const & shape)
+  {
+    double result = 1;
+    for(int_t x: shape) result *= x;
+    return result;
+  }
+
+  /** @brief Arithmetic cost of an operator, in flops per output element */
+  inline double flops_per_element(op_element const & op)
+  {
+    switch(op.type)
+    {
+      case ASSIGN_TYPE: case RESHAPE_TYPE: case TRANS_TYPE: case DIAG_VECTOR_TYPE:
+      case PAIR_TYPE: case OPERATOR_FUSE: case SFOR_TYPE: case ACCESS_INDEX_TYPE:
+        return 0;
+      case DIV_TYPE: case ELEMENT_DIV_TYPE: case SQRT_TYPE:
+        return 4;
+      case EXP_TYPE: case LOG_TYPE: case LOG10_TYPE:
+      case SIN_TYPE: case COS_TYPE: case TAN_TYPE:
+      case SINH_TYPE: case COSH_TYPE: case TANH_TYPE:
+      case ASIN_TYPE: case ACOS_TYPE: case ATAN_TYPE:
+        return 8;
+      case ELEMENT_POW_TYPE:
+        return 16;
+      default:
+        return is_cast(op.type)?0:1;
+    }
+  }
+
+  /** @brief Memory traffic, arithmetic and iteration space of the kernel rooted at root. Breakpoints are read as temporaries */
+  kernel_stats stats(expression_tree const & tree, size_t root, std::set<size_t> const & bp)
+  {
+    kernel_stats result;
+    std::set<array_base*> arrays;
+    auto recurse = [&](size_t idx){ return idx==root || bp.find(idx)==bp.end(); };
+    auto fun = [&](size_t idx)
+    {
+      expression_tree::node const & node = tree[idx];
+      double n = numel(node.shape);
+      result.space = std::max(result.space, n);
+      if(idx!=root && bp.find(idx)!=bp.end())
+        result.bytes += n*size_of(node.dtype);
+      else if(node.type==DENSE_ARRAY_TYPE && arrays.insert(node.array.base).second)
+        result.bytes += n*size_of(node.dtype);
+      else if(node.type==COMPOSITE_OPERATOR_TYPE)
+      {
+        op_element const & op = node.binary_operator.op;
+        expression_tree::node const & lhs = tree[node.binary_operator.lhs];
+        if(op.type_family==REDUCE || op.type_family==REDUCE_ROWS || op.type_family==REDUCE_COLUMNS)
+          result.flops += numel(lhs.shape);
+        else if(op.type_family==GEMM)
+        {
+          bool A_trans = op.type==GEMM_TN_TYPE || op.type==GEMM_TT_TYPE;
+          double K = (lhs.shape.size()<2)?1:(A_trans?lhs.shape[0]:lhs.shape[1]);
+          result.flops += 2*n*K;
+        }
+        else
+          result.flops += n*flops_per_element(op);
+      }
+    };
+    symbolic::traverse(tree, root, fun, recurse);
+    return result;
+  }
+
+  inline double predict(kernel_stats const & x, device_costs const & costs)
+  { return costs.launch + std::max(x.bytes/costs.bandwidth, x.flops/costs.flops); }
+
+  /** @brief Whether the subtree at idx is purely elementwise and can be evaluated into a temporary */
+  bool is_materializable(expression_tree const & tree, size_t idx, bool & has_array)
+  {
+    expression_tree::node const & node = tree[idx];
+    switch(node.type)
+    {
+      case DENSE_ARRAY_TYPE:
+        has_array = true;
+        return true;
+      case VALUE_SCALAR_TYPE:
+      case INVALID_SUBTYPE:
+        return true;
+      case COMPOSITE_OPERATOR_TYPE:
+      {
+        op_element const & op = node.binary_operator.op;
+        if(op.type_family!=UNARY_ARITHMETIC && op.type_family!=BINARY_ARITHMETIC)
+          return false;
+        if(is_assignment(op.type) || op.type==ACCESS_INDEX_TYPE || op.type==PAIR_TYPE || op.type==OPERATOR_FUSE
+           || op.type==SFOR_TYPE || op.type==DIAG_VECTOR_TYPE)
+          return false;
+        return is_materializable(tree, node.binary_operator.lhs, has_array)
+            && is_materializable(tree, node.binary_operator.rhs, has_array);
+      }
+      default:
+        return false;
+    }
+  }
+
+  /** @brief Walks down a kernel and splits out broadcast subexpressions when recomputing them costs more than a temporary */
+  void split(expression_tree const & tree, size_t idx, double space, device_costs const & costs,
+             std::set<size_t> const & mandatory, std::set<size_t> & bp)
+  {
+    expression_tree::node const & node = tree[idx];
+    if(node.type!=COMPOSITE_OPERATOR_TYPE || mandatory.find(idx)!=mandatory.end())
+      return;
+    double n = numel(node.shape);
+    bool has_array = false;
+    //Index modifiers are looked through rather than materialized
+    operation_type op = node.binary_operator.op.type;
+    bool is_modifier = op==RESHAPE_TYPE || op==TRANS_TYPE;
+    if(n < space && !is_modifier && node.dtype!=INVALID_NUMERIC_TYPE && is_materializable(tree, idx, has_array) && has_array)
+    {
+      kernel_stats sub = stats(tree, idx, bp);
+      double size = size_of(node.dtype);
+      //Extra time spent by the consumer evaluating the subexpression space/n times
+      double recompute = (space/n - 1)*sub.flops/costs.flops;
+      //Time spent by a separate kernel, plus the consumer reading the temporary instead of the operands
+      double materialize = costs.launch + std::max((sub.bytes + n*size)/costs.bandwidth, sub.flops/costs.flops)
+                         + (n*size - sub.bytes)/costs.bandwidth;
+      if(sub.flops > 0 && materialize < recompute)
+      {
+        bp.insert(idx);
+        space = n;
+      }
+    }
+    split(tree, node.binary_operator.lhs, space, costs, mandatory, bp);
+    split(tree, node.binary_operator.rhs, space, costs, mandatory, bp);
+  }
+
+  inline expression_type elementwise_type(tuple const & shape)
+  { return (numgt1(shape)<=1)?ELEMENTWISE_1D:ELEMENTWISE_2D; }
+
+}
+
+device_costs::device_costs(double _bandwidth, double _flops, double _launch) : bandwidth(_bandwidth), flops(_flops), launch(_launch)
+{ }
+
+device_costs device_costs::estimate(driver::Device const & device)
+{
+  //Peak figures derived from the device geometry; bandwidth and launch latency are typical values
+  double units = device.compute_units();
+  double clock = device.clock_rate()*((device.backend()==driver::CUDA)?1e3:1e6);
+  switch(device.type())
+  {
+    case driver::Device::Type::CPU: return device_costs(20e9, units*clock*16, 20e-6);
+    case driver::Device::Type::GPU: return device_costs(200e9, units*clock*128, 5e-6);
+    default: return device_costs(50e9, units*clock*32, 10e-6);
+  }
+}
+
+double execution_plan::time() const
+{
+  double result = final.time;
+  for(step const & x: temporaries)
+    result += x.time;
+  return result;
+}
+
+execution_plan planner::make(expression_tree const & tree, device_costs const & costs)
+{
+  execution_plan result;
+  size_t root = tree.root();
+  std::set<size_t> bp;
+  expression_type final_type;
+  /*----Matrix Product-----*/
+  if(symbolic::preset::gemm::args args = symbolic::preset::gemm::check(tree.data(), root))
+    final_type = args.type;
+  /*----Default-----*/
+  else
+  {
+    //Breakpoints required by the templates
+    detail::breakpoints_t breakpoints;
+    final_type = detail::parse(tree, breakpoints);
+    std::map<size_t, expression_type> types;
+    for(auto const & x: breakpoints)
+      types.insert(x);
+    std::set<size_t> mandatory;
+    for(auto const & x: types)
+      mandatory.insert(x.first);
+    bp = mandatory;
+    //Optional breakpoints, kernel by kernel
+    std::vector<size_t> kernels(mandatory.begin(), mandatory.end());
+    kernels.push_back(root);
+    for(size_t idx: kernels)
+    {
+      expression_tree::node const & node = tree[idx];
+      double space = detail::stats(tree, idx, mandatory).space;
+      detail::split(tree, node.binary_operator.lhs, space, costs, mandatory, bp);
+      detail::split(tree, node.binary_operator.rhs, space, costs, mandatory, bp);
+    }
+    //Children always have lower indices than their parents
+    for(size_t idx: bp)
+    {
+      expression_tree::node const & node = tree[idx];
+      bool is_mandatory = mandatory.find(idx)!=mandatory.end();
+      expression_type type = is_mandatory?types.at(idx):detail::elementwise_type(node.shape);
+      detail::kernel_stats x = detail::stats(tree, idx, bp);
+      x.bytes += detail::numel(node.shape)*size_of(node.dtype);
+      result.temporaries.push_back({idx, type, is_mandatory, x.bytes, x.flops, detail::predict(x, costs)});
+    }
+  }
+  detail::kernel_stats x = detail::stats(tree, root, bp);
+  result.final = {root, final_type, true, x.bytes, x.flops, detail::predict(x, costs)};
+  return result;
+}
+
+execution_plan planner::make(expression_tree const & tree)
+{ return make(tree, costs(tree.context().device())); }
+
+//Executions on different contexts may plan concurrently, and calibration overwrites the estimates
+device_costs planner::costs(driver::Device const & device)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<driver::Device, device_costs>::iterator it = costs_.find(device);
+  if(it==costs_.end())
+    return costs_.insert(std::make_pair(device, device_costs::estimate(device))).first->second;
+  return it->second;
+}
+
+void planner::set_costs(driver::Device const & device, device_costs const & costs)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  costs_[device] = costs;
+}
+
+size_t planner::registers(size_t private_bytes)
+{ return ADDRESSING_REGISTERS + (private_bytes + 3)/4; }
+
+size_t planner::resident_work_items(driver::Device const & device, size_t group_size, size_t private_bytes, size_t local_bytes)
+{
+  size_t groups = std::min(MAX_WORK_ITEMS_PER_COMPUTE_UNIT/group_size, REGISTERS_PER_COMPUTE_UNIT/(registers(private_bytes)*group_size));
+  if(local_bytes)
+    groups = std::min<size_t>(groups, device.local_mem_size()/local_bytes);
+  return groups*group_size;
+}
+
+std::map<driver::Device, device_costs> planner::costs_;
+std::mutex planner::mutex_;
+const size_t planner::MAX_REGISTERS_PER_WORK_ITEM;
+const size_t planner::REGISTERS_PER_COMPUTE_UNIT;
+const size_t planner::MAX_WORK_ITEMS_PER_COMPUTE_UNIT;
+const size_t planner::ADDRESSING_REGISTERS;
+
+std::string to_string(execution_plan const & plan)
+{
+  std::ostringstream oss;
+  auto print = [&](std::string const & name, execution_plan::step const & x)
+  {
+    oss << name << " node " << x.node << " (" << to_string(x.type) << (x.mandatory?"":", optional") << "): "
+        << x.bytes << " bytes, " << x.flops << " flops, " << x.time*1e6 << " us" << std::endl;
+  };
+  for(execution_plan::step const & x: plan.temporaries)
+    print("temporary", x);
+  print("final", plan.final);
+  oss << "total: " << plan.time()*1e6 << " us" << std::endl;
+  return oss.str();
+}
+
+}
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#include <stdexcept>
+
+#include "isaac/runtime/predictors/base.h"
+#include "isaac/runtime/predictors/gradient_boosting.h"
+#include "isaac/runtime/predictors/nearest_neighbors.h"
+#include "isaac/runtime/predictors/random_forest.h"
+#include "rapidjson/document.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+std::shared_ptr<base> create(std::string const & type, rapidjson::Value const & x)
+{
+  if(type=="random_forest")
+    return std::make_shared<random_forest>(x);
+  if(type=="nearest_neighbors")
+    return std::make_shared<nearest_neighbors>(x);
+  if(type=="gradient_boosting")
+    return std::make_shared<gradient_boosting>(x);
+  throw std::invalid_argument("Unknown predictor: " + type);
+}
+
+}
+}
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#include <limits>
+
+#include "isaac/runtime/predictors/gradient_boosting.h"
+#include "isaac/tools/cpp/string.hpp"
+#include "rapidjson/to_array.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+gradient_boosting::gradient_boosting(rapidjson::Value const & x) :
+  init_(rapidjson::to_float_array<float>(x["init"])), learning_rate_(x["learning_rate"].GetDouble())
+{
+  for(rapidjson::SizeType i = 0 ; i < x["stages"].Size() ; ++i)
+    stages_.push_back(random_forest::tree(x["stages"][i]));
+}
+
+gradient_boosting::gradient_boosting(std::vector<float> const & init, float learning_rate, std::vector<random_forest::tree> const & stages) :
+  init_(init), learning_rate_(learning_rate), stages_(stages)
+{ }
+
+std::vector<float> gradient_boosting::predict(std::vector<int_t> const & x) const
+{
+  std::vector<float> result = init_;
+  for(random_forest::tree const & stage: stages_)
+  {
+    std::vector<float> const & delta = stage.predict(x);
+    for(size_t i = 0 ; i < result.size() ; ++i)
+      result[i] += learning_rate_*delta[i];
+  }
+  return result;
+}
+
+std::string gradient_boosting::type() const
+{ return "gradient_boosting"; }
+
+void gradient_boosting::write(std::ostream & os) const
+{
+  std::streamsize precision = os.precision(std::numeric_limits<float>::max_digits10);
+  os << "{\"learning_rate\": " << learning_rate_ << ", \"init\": ";
+  tools::write_array(os, init_);
+  os << ", \"stages\": [";
+  for(size_t i = 0 ; i < stages_.size() ; ++i)
+  {
+    os << (i?", ":"");
+    stages_[i].write(os);
+  }
+  os << "]}";
+  os.precision(precision);
+}
+
+}
+}
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "isaac/runtime/predictors/nearest_neighbors.h"
+#include "isaac/tools/cpp/string.hpp"
+#include "rapidjson/to_array.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+//Missing values are stored as negative numbers, since JSON has no NAN
+nearest_neighbors::nearest_neighbors(rapidjson::Value const & x) : k_(x["k"].GetInt())
+{
+  for(rapidjson::SizeType i = 0 ; i < x["points"].Size() ; ++i)
+    points_.push_back(rapidjson::to_int_array<int_t>(x["points"][i]));
+  for(rapidjson::SizeType i = 0 ; i < x["values"].Size() ; ++i)
+  {
+    values_.push_back(rapidjson::to_float_array<float>(x["values"][i]));
+    for(float & v: values_.back())
+      if(v < 0) v = NAN;
+  }
+}
+
+nearest_neighbors::nearest_neighbors(size_t k, std::vector<std::vector<int_t> > const & points, std::vector<std::vector<float> > const & values) :
+  k_(k), points_(points), values_(values)
+{ }
+
+std::vector<float> nearest_neighbors::predict(std::vector<int_t> const & x) const
+{
+  std::vector<std::pair<double, size_t> > distances;
+  for(size_t i = 0 ; i < points_.size() ; ++i)
+  {
+    double d = 0;
+    for(size_t j = 0 ; j < x.size() ; ++j)
+    {
+      double delta = std::log2(1. + points_[i][j]) - std::log2(1. + x[j]);
+      d += delta*delta;
+    }
+    distances.push_back(std::make_pair(std::sqrt(d), i));
+  }
+  size_t k = std::min(k_, distances.size());
+  std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+  size_t D = values_.empty()?0:values_[0].size();
+  std::vector<float> result(D, 0);
+  for(size_t j = 0 ; j < D ; ++j)
+  {
+    double sum = 0, weights = 0;
+    for(size_t n = 0 ; n < k ; ++n)
+    {
+      float v = values_[distances[n].second][j];
+      if(std::isnan(v))
+        continue;
+      //A shape that was measured predicts itself
+      double w = 1/(distances[n].first + 1e-3);
+      sum += w*v;
+      weights += w;
+    }
+    result[j] = weights?sum/weights:0;
+  }
+  return result;
+}
+
+std::string nearest_neighbors::type() const
+{ return "nearest_neighbors"; }
+
+void nearest_neighbors::write(std::ostream & os) const
+{
+  std::streamsize precision = os.precision(std::numeric_limits<float>::max_digits10);
+  os << "{\"k\": " << k_ << ", \"points\": [";
+  for(size_t i = 0 ; i < points_.size() ; ++i)
+  {
+    os << (i?", ":"");
+    tools::write_array(os, points_[i]);
+  }
+  os << "], \"values\": [";
+  for(size_t i = 0 ; i < values_.size() ; ++i)
+  {
+    std::vector<float> values = values_[i];
+    for(float & v: values)
+      if(std::isnan(v)) v = -1;
+    os << (i?", ":"");
+    tools::write_array(os, values);
+  }
+  os << "]}";
+  os.precision(precision);
+}
+
+}
+}
+}
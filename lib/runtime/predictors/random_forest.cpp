@@ -19,7 +19,11 @@
  * MA 02110-1301  USA
  */
 
+#include <iomanip>
+#include <limits>
+
 #include "isaac/runtime/predictors/random_forest.h"
+#include "isaac/tools/cpp/string.hpp"
 #include "rapidjson/to_array.hpp"
 
 namespace isaac
@@ -41,6 +45,11 @@ random_forest::tree::tree(rapidjson::Value const & treerep)
   D_ = value_[0].size();
 }
 
+random_forest::tree::tree(std::vector<int> const & children_left, std::vector<int> const & children_right, std::vector<float> const & threshold,
+                          std::vector<float> const & feature, std::vector<std::vector<float> > const & value) :
+  children_left_(children_left), children_right_(children_right), threshold_(threshold), feature_(feature), value_(value), D_(value[0].size())
+{ }
+
 std::vector<float> const & random_forest::tree::predict(std::vector<int_t> const & x) const
 {
   int_t idx = 0;
@@ -51,6 +60,27 @@ std::vector<float> const & random_forest::tree::predict(std::vector<int_t> const
 
 size_t random_forest::tree::D() const { return D_; }
 
+void random_forest::tree::write(std::ostream & os) const
+{
+  std::streamsize precision = os.precision(std::numeric_limits<float>::max_digits10);
+  os << "{\"children_left\": ";
+  tools::write_array(os, children_left_);
+  os << ", \"children_right\": ";
+  tools::write_array(os, children_right_);
+  os << ", \"threshold\": ";
+  tools::write_array(os, threshold_);
+  os << ", \"feature\": ";
+  tools::write_array(os, feature_);
+  os << ", \"value\": [";
+  for(size_t i = 0 ; i < value_.size() ; ++i)
+  {
+    os << (i?", ":"");
+    tools::write_array(os, value_[i]);
+  }
+  os << "]}";
+  os.precision(precision);
+}
+
 random_forest::random_forest(rapidjson::Value const & estimators)
 {
   for(rapidjson::SizeType i = 0 ; i < estimators.Size() ; ++i)
@@ -58,6 +88,9 @@ random_forest::random_forest(rapidjson::Value const & estimators)
   D_ = estimators_.front().D();
 }
 
+random_forest::random_forest(std::vector<tree> const & estimators) : estimators_(estimators), D_(estimators.front().D())
+{ }
+
 std::vector<float> random_forest::predict(std::vector<int_t> const & x) const
 {
   std::vector<float> res(D_, 0);
@@ -75,6 +108,20 @@ std::vector<float> random_forest::predict(std::vector<int_t> const & x) const
 std::vector<random_forest::tree> const & random_forest::estimators() const
 { return estimators_; }
 
+std::string random_forest::type() const
+{ return "random_forest"; }
+
+void random_forest::write(std::ostream & os) const
+{
+  os << "[";
+  for(size_t i = 0 ; i < estimators_.size() ; ++i)
+  {
+    os << (i?", ":"");
+    estimators_[i].write(os);
+  }
+  os << "]";
+}
+
 }
 }
 }
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "isaac/runtime/predictors/roofline.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+namespace
+{
+  //Resident work-items per compute unit needed to hide the latency of global memory
+  const double LATENCY_HIDING_WORK_ITEMS = 512;
+
+  inline bool is_gemm(expression_type type)
+  { return type==GEMM_NN || type==GEMM_TN || type==GEMM_NT || type==GEMM_TT; }
+}
+
+roofline::roofline(driver::Device const & device) : device_(device), costs_(planner::costs(device))
+{ }
+
+double roofline::predict(templates::base const & tp, expression_tree const & tree, execution_plan::step const & kernel) const
+{
+  if(tp.is_invalid(tree, device_)!=templates::TEMPLATE_VALID)
+    return INFINITY;
+  double bytes = kernel.bytes, flops = kernel.flops;
+  std::vector<int> p = tp.parameters();
+  //Vendor libraries are assumed to reach the roofline
+  if(p.empty())
+    return costs_.launch + std::max(bytes/costs_.bandwidth, flops/costs_.flops);
+  std::vector<int_t> sizes = tp.input_sizes(tree);
+  double groups, size, compute = 1;
+  if(is_gemm(tp.type()))
+  {
+    //vwidth, ls0, kL, ls1, depth, ms, ks, ns, lf0, lf1
+    double M = sizes[0], N = sizes[1], K = sizes[2];
+    double mL = p[5]*p[1], nL = p[7]*p[3], depth = p[4];
+    double rows = std::ceil(M/mL), cols = std::ceil(N/nL);
+    //A is fetched once per column of tiles, B once per row of tiles; partial products make a round trip
+    bytes += size_of(tree.dtype())*(M*K*(cols - 1) + K*N*(rows - 1) + (depth > 1?2*M*N*depth:0));
+    groups = rows*cols*depth;
+    size = p[1]*p[3];
+    //Share of the inner loop spent on FMAs rather than on loads from local memory
+    compute = p[5]*p[7]/double(p[5]*p[7] + p[5] + p[7]);
+  }
+  else if(p.size()==3)
+  {
+    //vwidth, ls, ng
+    size = p[1];
+    groups = std::min<double>(p[2], std::ceil(sizes[0]/double(p[0]*p[1])));
+  }
+  else
+  {
+    //vwidth, ls0, ls1, ng0, ng1
+    size = p[1]*p[2];
+    groups = std::min<double>(p[3]*p[4], std::ceil(sizes[0]/double(p[1]))*std::ceil(sizes[1]/double(p[2])));
+  }
+  if(groups < 1)
+    return costs_.launch;
+  //Work-groups run in waves over the compute units; the last one may leave some idle
+  double units = device_.compute_units();
+  double balance = groups/(std::ceil(groups/units)*units);
+  //Latency hiding, from the work-items each compute unit keeps resident
+  double occupancy = 1;
+  if(device_.type()==driver::Device::Type::GPU)
+  {
+    double resident = planner::resident_work_items(device_, size_t(size), tp.registers_usage(tree), tp.lmem_usage(tree));
+    resident = std::min(resident, std::ceil(groups/units)*size);
+    occupancy = std::min(1., resident/LATENCY_HIDING_WORK_ITEMS);
+  }
+  if(occupancy <= 0)
+    return INFINITY;
+  return costs_.launch + std::max(bytes/(costs_.bandwidth*balance*occupancy), flops/(costs_.flops*balance*compute));
+}
+
+double roofline::predict(templates::base const & tp, expression_tree const & tree) const
+{ return predict(tp, tree, planner::make(tree, costs_).final); }
+
+std::vector<float> roofline::predict(std::vector<std::shared_ptr<templates::base> > const & templates, expression_tree const & tree) const
+{
+  execution_plan::step kernel = planner::make(tree, costs_).final;
+  std::vector<float> result;
+  result.reserve(templates.size());
+  for(std::shared_ptr<templates::base> const & tp: templates)
+  {
+    double time = predict(*tp, tree, kernel);
+    result.push_back((time==INFINITY)?0:float(1/time));
+  }
+  return result;
+}
+
+}
+}
+}
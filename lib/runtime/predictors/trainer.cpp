@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+#include "isaac/runtime/predictors/trainer.h"
+
+namespace isaac
+{
+namespace runtime
+{
+namespace predictors
+{
+
+namespace
+{
+  //Stages of gradient boosting are kept shallow
+  const size_t BOOSTING_DEPTH = 3;
+  //Folds of the cross-validation of "auto", and the rows it needs
+  const size_t FOLDS = 4;
+  const size_t MIN_ROWS_PER_FOLD = 2;
+}
+
+trainer::trainer(size_t D, options_type const & options) : D_(D), options_(options), generator_(options.seed)
+{ }
+
+void trainer::add(std::vector<int_t> const & x, std::vector<float> const & y)
+{
+  if(X_.size() && x.size()!=X_[0].size())
+    throw std::invalid_argument("Inconsistent number of input sizes");
+  X_.push_back(x);
+  Y_.push_back(y);
+  Y_.back().resize(D_, NAN);
+}
+
+size_t trainer::size() const
+{ return X_.size(); }
+
+//Targets are scaled to the best template of each row, so that large and small inputs weigh the same.
+//Predictions of the prior are scaled to the measurements by their median ratio, and fill the gaps.
+//Without normalization, the measurements are scaled to the prior instead
+void trainer::impute(base const * prior, bool normalize)
+{
+  targets_ = Y_;
+  for(size_t r = 0 ; r < X_.size() ; ++r)
+  {
+    std::vector<float> & y = targets_[r];
+    if(prior)
+    {
+      std::vector<float> p = prior->predict(X_[r]);
+      p.resize(D_, NAN);
+      std::vector<float> ratios;
+      for(size_t j = 0 ; j < D_ ; ++j)
+        if(!std::isnan(y[j]) && p[j] > 0)
+          ratios.push_back(y[j]/p[j]);
+      if(ratios.size())
+      {
+        std::nth_element(ratios.begin(), ratios.begin() + ratios.size()/2, ratios.end());
+        float ratio = ratios[ratios.size()/2];
+        for(size_t j = 0 ; j < D_ ; ++j)
+          if(std::isnan(y[j]) && !std::isnan(p[j]))
+            y[j] = ratio*p[j];
+        if(!normalize && ratio > 0)
+          for(float & v: y)
+            v /= ratio;
+      }
+    }
+    if(!normalize)
+      continue;
+    float best = 0;
+    for(float v: y)
+      if(!std::isnan(v))
+        best = std::max(best, v);
+    if(best > 0)
+      for(float & v: y)
+        v /= best;
+  }
+}
+
+//Mean of each output over the samples that have it, or the value of the parent
+std::vector<float> trainer::mean(std::vector<size_t> const & samples, std::vector<float> const & fallback) const
+{
+  std::vector<float> result(D_, 0);
+  for(size_t j = 0 ; j < D_ ; ++j)
+  {
+    double sum = 0;
+    size_t count = 0;
+    for(size_t s: samples)
+      if(!std::isnan(targets_[s][j]))
+      {
+        sum += targets_[s][j];
+        count++;
+      }
+    result[j] = count?sum/count:fallback[j];
+  }
+  return result;
+}
+
+//Split minimizing the sum of squared errors of both children, over the outputs present in each sample
+bool trainer::split(std::vector<size_t> const & samples, size_t & feature, float & threshold) const
+{
+  size_t n = samples.size();
+  auto sse = [](double count, double sum, double sumsq){ return count?sumsq - sum*sum/count:0; };
+  std::vector<double> count(D_, 0), sum(D_, 0), sumsq(D_, 0);
+  for(size_t s: samples)
+    for(size_t j = 0 ; j < D_ ; ++j)
+      if(!std::isnan(targets_[s][j]))
+      {
+        count[j]++;
+        sum[j] += targets_[s][j];
+        sumsq[j] += targets_[s][j]*targets_[s][j];
+      }
+  double best = 0;
+  for(size_t j = 0 ; j < D_ ; ++j)
+    best += sse(count[j], sum[j], sumsq[j]);
+  //Splits must do strictly better than the parent
+  best *= 1 - 1e-6;
+  bool found = false;
+  std::vector<size_t> sorted = samples;
+  for(size_t f = 0 ; f < X_[0].size() ; ++f)
+  {
+    std::sort(sorted.begin(), sorted.end(), [&](size_t a, size_t b){ return X_[a][f] < X_[b][f]; });
+    std::vector<double> lcount(D_, 0), lsum(D_, 0), lsumsq(D_, 0);
+    for(size_t i = 1 ; i < n ; ++i)
+    {
+      std::vector<float> const & y = targets_[sorted[i-1]];
+      for(size_t j = 0 ; j < D_ ; ++j)
+        if(!std::isnan(y[j]))
+        {
+          lcount[j]++;
+          lsum[j] += y[j];
+          lsumsq[j] += y[j]*y[j];
+        }
+      int_t lo = X_[sorted[i-1]][f], hi = X_[sorted[i]][f];
+      if(lo==hi || i < options_.min_samples_leaf || n - i < options_.min_samples_leaf)
+        continue;
+      double impurity = 0;
+      for(size_t j = 0 ; j < D_ ; ++j)
+        impurity += sse(lcount[j], lsum[j], lsumsq[j]) + sse(count[j] - lcount[j], sum[j] - lsum[j], sumsq[j] - lsumsq[j]);
+      if(impurity < best)
+      {
+        best = impurity;
+        feature = f;
+        threshold = .5f*(float(lo) + float(hi));
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+random_forest::tree trainer::grow(std::vector<size_t> const & samples, size_t max_depth) const
+{
+  std::vector<int> left, right;
+  std::vector<float> threshold, feature;
+  std::vector<std::vector<float> > value;
+  std::function<int(std::vector<size_t> const &, size_t, std::vector<float> const &)> build =
+      [&](std::vector<size_t> const & idx, size_t depth, std::vector<float> const & parent)
+  {
+    int id = (int)left.size();
+    std::vector<float> current = mean(idx, parent);
+    left.push_back(-1);
+    right.push_back(-1);
+    threshold.push_back(-2);
+    feature.push_back(-2);
+    value.push_back(current);
+    size_t f;
+    float t;
+    if(depth < max_depth && idx.size() >= 2*std::max<size_t>(options_.min_samples_leaf, 1) && split(idx, f, t))
+    {
+      std::vector<size_t> lidx, ridx;
+      for(size_t s: idx)
+        (X_[s][f] <= t ? lidx : ridx).push_back(s);
+      feature[id] = (float)f;
+      threshold[id] = t;
+      int l = build(lidx, depth + 1, current);
+      left[id] = l;
+      int r = build(ridx, depth + 1, current);
+      right[id] = r;
+    }
+    return id;
+  };
+  build(samples, 0, std::vector<float>(D_, 0));
+  return random_forest::tree(left, right, threshold, feature, value);
+}
+
+//The first tree is grown on every row, the others on bootstrap samples
+std::vector<random_forest::tree> trainer::grow()
+{
+  if(X_.empty())
+    throw std::runtime_error("No timings to train on");
+  std::vector<random_forest::tree> result;
+  std::uniform_int_distribution<size_t> pick(0, X_.size() - 1);
+  for(size_t t = 0 ; t < std::max<size_t>(options_.trees, 1) ; ++t)
+  {
+    std::vector<size_t> samples(X_.size());
+    if(t==0 || X_.size()==1)
+      std::iota(samples.begin(), samples.end(), 0);
+    else
+      for(size_t & s: samples)
+        s = pick(generator_);
+    result.push_back(grow(samples, options_.depth));
+  }
+  return result;
+}
+
+//Squared loss: each stage is fit on the residuals of the previous ones
+gradient_boosting trainer::boost()
+{
+  if(X_.empty())
+    throw std::runtime_error("No timings to train on");
+  std::vector<std::vector<float> > targets = targets_;
+  std::vector<size_t> samples(X_.size());
+  std::iota(samples.begin(), samples.end(), 0);
+  std::vector<float> init = mean(samples, std::vector<float>(D_, 0));
+  std::vector<std::vector<float> > current(X_.size(), init);
+  std::vector<random_forest::tree> stages;
+  for(size_t t = 0 ; t < options_.trees ; ++t)
+  {
+    for(size_t r = 0 ; r < X_.size() ; ++r)
+      for(size_t j = 0 ; j < D_ ; ++j)
+        targets_[r][j] = targets[r][j] - current[r][j];
+    stages.push_back(grow(samples, std::min(options_.depth, BOOSTING_DEPTH)));
+    for(size_t r = 0 ; r < X_.size() ; ++r)
+    {
+      std::vector<float> const & delta = stages.back().predict(X_[r]);
+      for(size_t j = 0 ; j < D_ ; ++j)
+        current[r][j] += options_.learning_rate*delta[j];
+    }
+  }
+  targets_ = targets;
+  return gradient_boosting(init, options_.learning_rate, stages);
+}
+
+std::shared_ptr<base> trainer::fit(std::string const & model, base const * prior)
+{
+  impute(prior);
+  if(model=="random_forest")
+    return std::make_shared<random_forest>(grow());
+  if(model=="gradient_boosting")
+    return std::make_shared<gradient_boosting>(boost());
+  if(model=="nearest_neighbors")
+  {
+    if(X_.empty())
+      throw std::runtime_error("No timings to train on");
+    return std::make_shared<nearest_neighbors>(options_.neighbors, X_, targets_);
+  }
+  throw std::invalid_argument("Unknown predictor: " + model);
+}
+
+//Cross-validation on the measured templates: the score of a row is the performance of the predicted best, relative to the measured best
+std::string trainer::select(base const * prior)
+{
+  static const std::vector<std::string> models = {"random_forest", "gradient_boosting", "nearest_neighbors"};
+  if(X_.size() < FOLDS*MIN_ROWS_PER_FOLD)
+    return models[0];
+  std::string result = models[0];
+  double best = -1;
+  for(std::string const & model: models)
+  {
+    double score = 0;
+    for(size_t fold = 0 ; fold < FOLDS ; ++fold)
+    {
+      trainer train(D_, options_);
+      for(size_t r = 0 ; r < X_.size() ; ++r)
+        if(r % FOLDS != fold)
+          train.add(X_[r], Y_[r]);
+      std::shared_ptr<base> predictor = train.fit(model, prior);
+      for(size_t r = fold ; r < X_.size() ; r += FOLDS)
+      {
+        std::vector<float> p = predictor->predict(X_[r]);
+        float measured = 0, chosen = 0, prediction = -INFINITY;
+        for(size_t j = 0 ; j < D_ ; ++j)
+          if(!std::isnan(Y_[r][j]))
+          {
+            measured = std::max(measured, Y_[r][j]);
+            if(p[j] > prediction)
+            {
+              prediction = p[j];
+              chosen = Y_[r][j];
+            }
+          }
+        if(measured > 0)
+          score += chosen/measured;
+      }
+    }
+    //Ties go to the forest
+    if(score > best)
+    {
+      best = score;
+      result = model;
+    }
+  }
+  return result;
+}
+
+std::shared_ptr<base> trainer::fit(base const * prior)
+{
+  return fit((options_.model=="auto")?select(prior):options_.model, prior);
+}
+
+//Forests predicting fewer templates than the rows can not be extended, and are replaced.
+//Otherwise the new trees are fit in the units of the forest, on the corrections after which the whole forest predicts the rows
+random_forest trainer::extend(random_forest const & forest)
+{
+  std::vector<random_forest::tree> result;
+  if(forest.estimators().front().D()==D_)
+    result = forest.estimators();
+  impute(&forest, result.empty());
+  if(result.size())
+  {
+    float weight = float(result.size())/std::max<size_t>(options_.trees, 1);
+    for(size_t r = 0 ; r < X_.size() ; ++r)
+    {
+      std::vector<float> p = forest.predict(X_[r]);
+      for(size_t j = 0 ; j < D_ ; ++j)
+        if(!std::isnan(targets_[r][j]))
+          targets_[r][j] += weight*(targets_[r][j] - p[j]);
+    }
+  }
+  for(random_forest::tree const & x: grow())
+    result.push_back(x);
+  return random_forest(result);
+}
+
+}
+}
+}
@@ -20,23 +20,37 @@
  */
 
 #include <fstream>
+#include <iterator>
 #include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
 #include <memory>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <sys/stat.h>
 
 #include "rapidjson/document.h"
 #include "rapidjson/to_array.hpp"
+#include "tinysha1/sha1.hpp"
 
+#include "isaac/driver/disk_cache.h"
 #include "isaac/driver/program_cache.h"
+#include "isaac/runtime/execute.h"
 #include "isaac/runtime/profiles.h"
+#include "isaac/runtime/predictors/roofline.h"
+#include "isaac/runtime/telemetry.h"
 #include "isaac/jit/generation/elementwise_1d.h"
 #include "isaac/jit/generation/reduce_1d.h"
 #include "isaac/jit/generation/elementwise_2d.h"
 #include "isaac/jit/generation/reduce_2d.h"
 #include "isaac/jit/generation/gemm.h"
 #include "isaac/exception/api.h"
+#include "isaac/exception/driver.h"
 #include "isaac/jit/syntax/engine/process.h"
 #include "isaac/tools/sys/getenv.hpp"
+#include "isaac/tools/sys/mkdir.hpp"
 #include "isaac/tools/cpp/string.hpp"
 #include "isaac/tools/cpp/timer.hpp"
 namespace isaac
@@ -44,61 +58,309 @@ namespace isaac
 namespace runtime
 {
 
-driver::Program const & profiles::value_type::init(runtime::execution_handler const & expression)
+namespace
+{
+  //Saved profiles: labels are keyed by the input sizes before version 2, by the input features from then on
+  const int FORMAT_VERSION = 2;
+
+  std::time_t mtime(std::string const & path)
+  {
+    struct stat st;
+    return (path.size() && stat(path.c_str(), &st)==0)?st.st_mtime:0;
+  }
+
+  bool exists(std::string const & path)
+  {
+    struct stat st;
+    return path.size() && stat(path.c_str(), &st)==0;
+  }
+
+  std::string default_directory()
+  {
+    std::string result = tools::getenv("ISAAC_PROFILES_DIR");
+    if(result.size())
+      return result;
+    std::string homepath = tools::getenv("HOME");
+    return homepath.empty()?"":homepath + "/.isaac/devices";
+  }
+
+  //Devices without a profile of their own share the file of previous versions
+  std::string user_profile(driver::Device const & device)
+  {
+    std::string result = profiles::path(device);
+    if(result.empty() || exists(result))
+      return result;
+    //The legacy file was written for the default device, and would mislead the others
+    std::vector<driver::Device> devices;
+    driver::backend::contexts::devices(devices);
+    if(driver::backend::default_device >= devices.size() || !(devices[driver::backend::default_device]==device))
+      return result;
+    std::string legacy = result.substr(0, result.find_last_of('/') + 1) + "device0.json";
+    return exists(legacy)?legacy:result;
+  }
+}
+
+/** @brief Predicted performance of each template, blending the predictor with the roofline model */
+std::vector<float> profiles::value_type::predict(runtime::execution_handler const & expression)
+{
+  std::vector<int_t> x = templates_[0]->input_features(expression.x());
+  std::vector<float> result = predictor_?predictor_->predict(x):std::vector<float>();
+  //Forests of the database only split on the input sizes, which come first
+  //Templates added after training have no prediction, and come last
+  result.resize(templates_.size(), 0);
+  if(roofline_ <= 0)
+    return result;
+  std::vector<float> model = predictors::roofline(expression.x().context().device()).predict(templates_, expression.x());
+  //Both are scaled to their best template, since the predictor is trained on other hardware
+  float fmax = *std::max_element(result.begin(), result.end());
+  float mmax = *std::max_element(model.begin(), model.end());
+  float weight = (fmax > 0)?roofline_:1;
+  for(size_t i = 0 ; i < result.size() ; ++i)
+    result[i] = (1 - weight)*((fmax > 0)?result[i]/fmax:0) + weight*((mmax > 0)?model[i]/mmax:0);
+  return result;
+}
+
+std::string profiles::value_type::program_name(runtime::execution_handler const & expression)
 {
-  driver::Context & context = (driver::Context&)expression.x().context();
-  std::string pname;
   runtime::compilation_options_type const & opt = expression.compilation_options();
   if(opt.program_name.empty())
-    pname = symbolic::hash(expression.x());
-  else
-    pname = opt.program_name;
+    return symbolic::hash(expression.x()) + "_" + tag_;
+  return opt.program_name + "_" + tag_;
+}
 
-  driver::Program const * program = cache_.find(pname);
+std::string profiles::value_type::generate(runtime::execution_handler const & expression)
+{
+  driver::Device const & device = expression.x().context().device();
+  std::string srcs;
+  for(unsigned int i = 0 ; i < templates_.size() ; ++i)
+    srcs += templates_[i]->generate(tools::to_string(i), expression.x(), device);
+  return srcs;
+}
 
+/** @brief Identifies the binaries of an expression without generating its source. Each device of the context keys its own */
+std::string profiles::value_type::signature(runtime::execution_handler const & expression)
+{ return "isaac-" ISAAC_VERSION "_" + templates::base::generator_id() + "_" + symbolic::hash(expression.x()) + parameters_; }
+
+driver::Program const * profiles::value_type::find(runtime::execution_handler const & expression)
+{
+  std::string pname = program_name(expression);
+  driver::Program const * program = cache_.find(pname);
   if(program)
+    return program;
+  //Programs are shared by all the queues of the context, so every device needs its binary
+  driver::Context const & context = expression.x().context();
+  std::vector<driver::Device> devices = context.devices();
+  std::string sig = signature(expression);
+  std::vector<std::string> binaries(devices.size());
+  for(size_t i = 0 ; i < devices.size() ; ++i)
+    if(!driver::DiskCache::get().load(driver::DiskCache::key(devices[i], sig), binaries[i]))
+      return NULL;
+  try{
+    return &cache_.add(pname, driver::Program::load(context, binaries));
+  }catch(exception::ocl::base const &){
+  }catch(exception::cuda::base const &){
+  }
+  //Rejected by the driver; the program is regenerated and the entry overwritten
+  return NULL;
+}
+
+driver::Program const & profiles::value_type::add(runtime::execution_handler const & expression, driver::Program const & program)
+{
+  std::vector<driver::Device> devices = program.context().devices();
+  std::vector<std::string> binaries = program.binaries();
+  std::string sig = signature(expression);
+  for(size_t i = 0 ; i < devices.size() && i < binaries.size() ; ++i)
+    driver::DiskCache::get().store(driver::DiskCache::key(devices[i], sig), binaries[i]);
+  return cache_.add(program_name(expression), program);
+}
+
+driver::Program const & profiles::value_type::init(runtime::execution_handler const & expression)
+{
+  driver::Context const & context = expression.x().context();
+  runtime::compilation_options_type const & opt = expression.compilation_options();
+
+  //A build started by tiered compilation is waited for rather than duplicated
+  pending_type::iterator it = pending_.find(program_name(expression));
+  if(it!=pending_.end())
+    return finish(expression, it);
+
+  if(!opt.recompile)
+  {
+    driver::Program const * program = find(expression);
+    if(program)
       return *program;
+  }
 
-  std::string srcs;
-   for(unsigned int i = 0 ; i < templates_.size() ; ++i)
-     srcs += templates_[i]->generate(tools::to_string(i), expression.x(), context.device());
-   return cache_.add(context, pname, srcs);
+  //add() stores the binary on disk under its signature
+  return add(expression, driver::ProgramCache::compile(context, generate(expression), false));
 }
 
-profiles::value_type::value_type(expression_type etype, numeric_type dtype, predictors::random_forest const & predictor, std::vector< std::shared_ptr<templates::base> > const & templates, driver::CommandQueue const & queue) :
-  templates_(templates), predictor_(new predictors::random_forest(predictor)), queue_(queue), cache_(driver::backend::programs::get(queue,etype,dtype))
+driver::Program const & profiles::value_type::finish(runtime::execution_handler const & expression, pending_type::iterator it)
 {
-  cache_.clear();
+  std::string pname = it->first;
+  std::future<driver::Program> build = std::move(it->second);
+  pending_.erase(it);
+  driver::Program const & result = add(expression, build.get());
+  //The baselines are no longer needed
+  for(size_t i = 0 ; i < templates_.size() ; ++i)
+    cache_.erase(pname + "_baseline" + tools::to_string(i));
+  return result;
+}
+
+bool profiles::value_type::execute_baseline(runtime::execution_handler const & expression)
+{
+  driver::Context const & context = expression.x().context();
+  std::string pname = program_name(expression);
+  if(find(expression))
+    return false;
+  //Full program
+  pending_type::iterator it = pending_.find(pname);
+  if(it==pending_.end())
+  {
+    std::string srcs = generate(expression);
+    driver::Context ctx = context;
+    it = pending_.insert(std::make_pair(pname, std::async(std::launch::async, [ctx, srcs]{ return driver::ProgramCache::compile(ctx, srcs, false); }))).first;
+  }
+  if(it->second.wait_for(std::chrono::seconds(0))==std::future_status::ready)
+  {
+    finish(expression, it);
+    return false;
+  }
+  //Baseline: the template already chosen for these sizes, or else the best valid prediction
+  std::vector<int_t> x = templates_[0]->input_features(expression.x());
+  driver::Device const & device = context.device();
+  auto usable = [&](size_t k){ return templates_[k]->is_invalid(expression.x(), device)==templates::TEMPLATE_VALID
+                                      && templates_[k]->temporary_workspace(expression.x()) <= MAX_TEMPORARY_WORKSPACE; };
+  auto label = labels_.find(x);
+  size_t i = templates_.size();
+  if(label!=labels_.end())
+    i = label->second;
+  else
+  {
+    std::vector<float> perf = predict(expression);
+    for(size_t k = 0 ; k < perf.size() ; ++k)
+      if((i==templates_.size() || perf[k] > perf[i]) && usable(k))
+        i = k;
+  }
+  //Nothing usable: wait for the full program
+  if(i==templates_.size())
+  {
+    finish(expression, it);
+    return false;
+  }
+  std::string id = tools::to_string(i);
+  std::string bname = pname + "_baseline" + id;
+  try{
+    driver::Program const * program = cache_.find(bname);
+    if(!program)
+      program = &cache_.add((driver::Context&)context, bname, templates_[i]->generate(id, expression.x(), device));
+    templates_[i]->enqueue(expression.execution_options().queue(context), *program, id, expression);
+  }catch(operation_not_supported_exception const &){
+    finish(expression, it);
+    return false;
+  }
+  return true;
 }
 
+void profiles::value_type::set_roofline(double weight)
+{ roofline_ = std::min(1., std::max(0., weight)); }
+
+void profiles::value_type::set_tiered(bool enabled)
+{ tiered_ = enabled; }
+
+bool profiles::value_type::tiered_ = tools::getenv("ISAAC_TIERED_JIT")=="1";
+
+profiles::value_type::value_type(expression_type etype, numeric_type dtype, std::shared_ptr<predictors::base> const & predictor, std::vector< std::shared_ptr<templates::base> > const & templates, driver::CommandQueue const & queue) :
+  templates_(templates), predictor_(predictor), roofline_(0), cache_(driver::backend::programs::get(queue.context(),etype,dtype))
+{ set_parameters(); }
+
 
-profiles::value_type::value_type(numeric_type dtype, std::shared_ptr<templates::base> const & tp, driver::CommandQueue const & queue) : templates_(1,tp), queue_(queue), cache_(driver::backend::programs::get(queue,tp->type(),dtype))
+profiles::value_type::value_type(numeric_type dtype, std::shared_ptr<templates::base> const & tp, driver::CommandQueue const & queue) : templates_(1,tp), roofline_(0), cache_(driver::backend::programs::get(queue.context(),tp->type(),dtype))
+{ set_parameters(); }
+
+profiles::value_type::value_type(value_type const & other) :
+  templates_(other.templates_), parameters_(other.parameters_), tag_(other.tag_), predictor_(other.predictor_), roofline_(other.roofline_),
+  labels_(other.labels_), measurements_(other.measurements_), cache_(other.cache_)
+{ }
+
+profiles::value_type::value_type(value_type const & other, std::shared_ptr<templates::base> const & extra) :
+  templates_(other.templates_), predictor_(other.predictor_), roofline_(other.roofline_), labels_(other.labels_), measurements_(other.measurements_), cache_(other.cache_)
 {
-  cache_.clear();
+  templates_.push_back(extra);
+  set_parameters();
+}
+
+profiles::value_type::value_type(value_type const & other, std::shared_ptr<predictors::base> const & predictor) :
+  templates_(other.templates_), parameters_(other.parameters_), tag_(other.tag_), predictor_(predictor), roofline_(other.roofline_),
+  labels_(other.labels_), measurements_(other.measurements_), cache_(other.cache_)
+{ }
+
+void profiles::value_type::set_parameters()
+{
+  parameters_.clear();
+  for(template_pointer const & tp: templates_)
+  {
+    parameters_ += "_" + tools::to_string(tp->type());
+    for(int x: tp->parameters())
+      parameters_ += "," + tools::to_string(x);
+  }
+  tag_ = tools::sha1(parameters_);
 }
 
 void profiles::value_type::execute(runtime::execution_handler const & expr)
 {
-  static const int MAX_TEMPORARY_WORKSPACE = 1e6;
+  runtime::dispatcher_options_type const & dispatcher = expr.dispatcher_options();
+  //Tiered compilation. Device-side compilation off the main thread is only supported on OpenCL
+  if(tiered_ && predictor_ && dispatcher.label<0 && !dispatcher.tune && !expr.compilation_options().recompile
+     && expr.x().context().backend()==driver::OPENCL && execute_baseline(expr))
+    return;
   driver::Program const & program = init(expr);
-  std::vector<int_t> x = templates_[0]->input_sizes(expr.x());
+  //Programs and labels are shared by every queue of the context; kernels go to the queue of the expression
+  driver::CommandQueue & queue = expr.execution_options().queue(expr.x().context());
+  std::vector<int_t> x = templates_[0]->input_features(expr.x());
+
+  //Forced
+  if(dispatcher.label>=0){
+    if(size_t(dispatcher.label) >= templates_.size())
+      throw std::out_of_range("Template label " + tools::to_string(dispatcher.label) + " out of range");
+    templates_[dispatcher.label]->enqueue(queue, program, tools::to_string(dispatcher.label), expr);
+    return;
+  }
 
   //Cached
   auto it = labels_.find(x);
-  if(it!=labels_.end()){
-    templates_[it->second]->enqueue(queue_, program, tools::to_string(it->second), expr);
+  if(it!=labels_.end() && !dispatcher.tune){
+    if(telemetry::sampling()){
+      queue.synchronize();
+      tools::Timer timer(true);
+      templates_[it->second]->enqueue(queue, program, tools::to_string(it->second), expr);
+      queue.synchronize();
+      telemetry::sample(templates_[0]->type(), expr.x().dtype(), x, it->second, 1e-9*timer.get().count());
+    }
+    else
+      templates_[it->second]->enqueue(queue, program, tools::to_string(it->second), expr);
     return;
   }
 
-  //Not cached
+  //Not cached, or re-tuned: tuning benchmarks every template rather than the best predictions
+  size_t ncandidates = dispatcher.tune?templates_.size():5;
   tools::Timer tmr;
   std::vector<double> times;
-  std::vector<float> perf = predictor_->predict(x);
+  std::vector<float> perf = predict(expr);
   std::vector<size_t> idx(perf.size());
   std::iota(idx.begin(), idx.end(), 0);
   std::sort(idx.begin(), idx.end(), [&perf](size_t i1, size_t i2) {return perf[i1] > perf[i2];});
+  //Analytic pre-filter, unless it leaves nothing to benchmark. Tuning measures every template
+  if(!dispatcher.tune)
+  {
+    std::vector<size_t> plausible;
+    driver::Device const & device = queue.device();
+    std::copy_if(idx.begin(), idx.end(), std::back_inserter(plausible), [&](size_t i){ return templates_[i]->is_implausible(expr.x(), device)==templates::TEMPLATE_VALID; });
+    if(plausible.size())
+      idx = plausible;
+  }
   bool valid_found = false;
-  for(size_t k = 0 ; k < std::min<size_t>(5, idx.size()) || !valid_found ; k++){
+  for(size_t k = 0 ; k < idx.size() && (k < ncandidates || !valid_found) ; k++){
     size_t i = idx[k];
     if(templates_[i]->temporary_workspace(expr.x()) > MAX_TEMPORARY_WORKSPACE){
       times.push_back(INFINITY);
@@ -109,8 +371,8 @@ void profiles::value_type::execute(runtime::execution_handler const & expr)
       std::vector<double> ctimes;
       while(total_time < 1e-2){
         tmr.start();
-        templates_[i]->enqueue(queue_, program, tools::to_string(i), runtime::execution_handler(expr.x()));
-        queue_.synchronize();
+        templates_[i]->enqueue(queue, program, tools::to_string(i), runtime::execution_handler(expr.x(), runtime::execution_options_type(queue)));
+        queue.synchronize();
         ctimes.push_back(1e-9*tmr.get().count());
         total_time += ctimes.back();
       }
@@ -120,9 +382,12 @@ void profiles::value_type::execute(runtime::execution_handler const & expr)
       times.push_back(INFINITY);
     }
   }
+  for(size_t k = 0 ; k < times.size() ; ++k)
+    record(x, (int)idx[k], times[k]);
+  telemetry::record(templates_[0]->type(), expr.x().dtype(), x, std::vector<int>(idx.begin(), idx.begin() + times.size()), times);
   size_t i = idx[std::distance(times.begin(),std::min_element(times.begin(), times.end()))];
-  labels_.insert({x, i});
-  templates_[i]->enqueue(queue_, program, tools::to_string(i), expr);
+  labels_[x] = i;
+  templates_[i]->enqueue(queue, program, tools::to_string(i), expr);
 }
 
 profiles::value_type::templates_container const & profiles::value_type::templates() const
@@ -130,6 +395,41 @@ profiles::value_type::templates_container const & profiles::value_type::template
     return templates_;
 }
 
+std::map<std::vector<int_t>, int> const & profiles::value_type::labels() const
+{
+    return labels_;
+}
+
+void profiles::value_type::set_label(std::vector<int_t> const & sizes, int label)
+{
+    if(label < 0 || size_t(label) >= templates_.size())
+      throw std::out_of_range("Template label " + tools::to_string(label) + " out of range");
+    labels_[sizes] = label;
+}
+
+std::shared_ptr<predictors::base> const & profiles::value_type::predictor() const
+{
+    return predictor_;
+}
+
+std::map<std::vector<int_t>, std::vector<float> > const & profiles::value_type::measurements() const
+{
+    return measurements_;
+}
+
+//Templates that fail to run have no performance
+void profiles::value_type::record(std::vector<int_t> const & sizes, int label, double time)
+{
+    std::vector<float> & row = measurements_[sizes];
+    row.resize(templates_.size(), NAN);
+    row[label] = (time==INFINITY)?0:1/time;
+}
+
+double profiles::value_type::roofline() const
+{
+    return roofline_;
+}
+
 std::shared_ptr<templates::base> profiles::create(std::string const & op, std::string const & str)
 {
     if(str=="cublas_gemm"){
@@ -165,15 +465,15 @@ std::shared_ptr<templates::base> profiles::create(std::string const & template_n
     throw std::invalid_argument("Invalid expression: " + template_name);
 }
 
-void profiles::import(std::string const & str, driver::CommandQueue const & queue)
+void profiles::import(std::string const & str, driver::CommandQueue const & queue, map_type & result)
 {
-  map_type & result = cache_[queue];
   //Parse the JSON document
   rapidjson::Document document;
   document.Parse<0>(str.c_str());
   //Deserialize
   std::vector<std::string> operations = {"elementwise_1d", "reduce_1d", "elementwise_2d", "reduce_2d_rows", "reduce_2d_cols", "gemm_nn", "gemm_tn", "gemm_nt", "gemm_tt"};
   std::vector<std::string> dtype = {"float32", "float64"};
+  int version = (document.IsObject() && document.HasMember("version"))?document["version"].GetInt():1;
   for(auto & operation : operations)
   {
     const char * opcstr = operation.c_str();
@@ -195,63 +495,295 @@ void profiles::import(std::string const & str, driver::CommandQueue const & queu
             else
                 templates.push_back(create(operation, rapidjson::to_int_array<int>(profiles[i])));
           }
-          if(templates.size()>1){
-            // Get predictor
-            predictors::random_forest predictor(document[opcstr][dtcstr]["predictor"]);
-            result[{etype, dtype}] = std::make_shared<value_type>(etype, dtype, predictor, templates, queue);
+          std::shared_ptr<value_type> profile;
+          if(templates.size()>1 && document[opcstr][dtcstr].HasMember("predictor")){
+            // Get predictor. Forests unless stated otherwise
+            rapidjson::Value const & entry = document[opcstr][dtcstr];
+            std::string type = entry.HasMember("predictor_type")?entry["predictor_type"].GetString():"random_forest";
+            std::shared_ptr<predictors::base> predictor = predictors::create(type, entry["predictor"]);
+            profile = std::make_shared<value_type>(etype, dtype, predictor, templates, queue);
           }
-          else
-            result[{etype, dtype}] = std::make_shared<value_type>(dtype, templates[0], queue);
+          else{
+            // Saved profiles may hold templates added at runtime, which only labels select
+            profile = std::make_shared<value_type>(dtype, templates[0], queue);
+            for(size_t i = 1 ; i < templates.size() ; ++i)
+              profile = std::make_shared<value_type>(*profile, templates[i]);
+          }
+          // Get labels and roofline weight, written by save(). Labels of older versions have other keys
+          if(document[opcstr][dtcstr].HasMember("labels") && version==FORMAT_VERSION){
+            rapidjson::Value const & labels = document[opcstr][dtcstr]["labels"];
+            for(rapidjson::SizeType i = 0 ; i < labels.Size() ; ++i)
+              profile->set_label(rapidjson::to_int_array<int_t>(labels[i]["sizes"]), labels[i]["template"].GetInt());
+          }
+          if(document[opcstr][dtcstr].HasMember("roofline"))
+            profile->set_roofline(document[opcstr][dtcstr]["roofline"].GetDouble());
+          result[{etype, dtype}] = profile;
         }
       }
     }
   }
 }
 
-profiles::map_type& profiles::init(driver::CommandQueue const & queue)
+//Preset of the known device of the same type with the closest fingerprint, if close enough
+const char * profiles::nearest(driver::CommandQueue const & queue)
 {
-  map_type & map = cache_[queue];
+  static const double VENDOR_PENALTY = .5;
+  static const double MAX_DISTANCE = 1.5;
+  driver::Device const & device = queue.device();
+  //Measuring is pointless when no reference has the type of the device
+  if(std::none_of(references_.begin(), references_.end(), [&](references_type::value_type const & ref){ return std::get<0>(ref)==device.type(); }))
+    return NULL;
+  try{
+    //A private queue, so that the probes neither wait for nor delay the work of the application
+    driver::CommandQueue probes(queue.context(), device);
+    fingerprint const & x = calibration::get(probes);
+    const char * result = NULL;
+    double best = MAX_DISTANCE;
+    for(auto const & ref: references_)
+    {
+      if(std::get<0>(ref)!=device.type())
+        continue;
+      double distance = x.distance(std::get<2>(ref)) + ((std::get<1>(ref)==device.vendor())?0:VENDOR_PENALTY);
+      if(distance < best)
+      {
+        best = distance;
+        result = std::get<3>(ref);
+      }
+    }
+    return result;
+  }catch(std::exception const &){
+    //Probes that fail to build or run leave the device on the default profile
+    return NULL;
+  }
+}
+
+std::shared_ptr<profiles::map_type> profiles::load(driver::CommandQueue const & queue)
+{
+  std::shared_ptr<map_type> map = std::make_shared<map_type>();
   driver::Device const & device = queue.device();
   //Default
-  import(presets_.at(std::make_tuple(driver::Device::Type::UNKNOWN, driver::Device::Vendor::UNKNOWN, driver::Device::Architecture::UNKNOWN)), queue);
+  import(presets_.at(std::make_tuple(driver::Device::Type::UNKNOWN, driver::Device::Vendor::UNKNOWN, driver::Device::Architecture::UNKNOWN)), queue, *map);
+  //The default was trained on other hardware. Profiles imported below replace it, and do not use the roofline model
+  for(auto & x: *map)
+    x.second->set_roofline(roofline_weight_);
   //Database profile
   presets_type::const_iterator it = presets_.find(std::make_tuple(device.type(), device.vendor(), device.architecture()));
   if(it!=presets_.end())
-      import(it->second, queue);
+      import(it->second, queue, *map);
+  else if(const char * preset = calibration_?nearest(queue):NULL)
+      import(preset, queue, *map);
   //User-provided profile
-  std::string homepath = tools::getenv("HOME");
-  if(homepath.size())
+  std::string json_path = user_profile(queue.device());
+  if(json_path.empty())
+    return map;
+  std::ifstream ifs(json_path);
+  if(!ifs)
+    return map;
+  std::string str;
+  ifs.seekg(0, std::ios::end);
+  str.reserve(ifs.tellg());
+  ifs.seekg(0, std::ios::beg);
+  str.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+  import(str, queue, *map);
+  return map;
+}
+
+//Checks the user profile of a context at most once per second
+void profiles::poll(driver::CommandQueue const & queue)
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
   {
-    std::string json_path = homepath + "/.isaac/devices/device0.json";
-    std::ifstream ifs(json_path);
-    if(!ifs)
-        return map;
-    std::string str;
-    ifs.seekg(0, std::ios::end);
-    str.reserve(ifs.tellg());
-    ifs.seekg(0, std::ios::beg);
-    str.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-    import(str, queue);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sources_.find(queue.context());
+    if(it==sources_.end() || now - it->second.polled < std::chrono::seconds(1))
+      return;
+    it->second.polled = now;
+    if(mtime(user_profile(queue.device()))==it->second.mtime)
+      return;
   }
-
-  return map;
+  reload(queue);
 }
 
-profiles::map_type& profiles::get(driver::CommandQueue const & queue)
+std::shared_ptr<profiles::map_type> profiles::snapshot(driver::CommandQueue const & queue)
 {
-  std::map<driver::CommandQueue, map_type>::iterator it = cache_.find(queue);
+  if(watch_)
+    poll(queue);
+  //Profiles refer to the program caches of their context, which a sweep of foreign contexts releases.
+  //Registered outside the lock, which sweeps take after that of the backend
+  static std::once_flag registered;
+  std::call_once(registered, []{ driver::backend::contexts::on_release([](driver::Context const & context){ release(context); }); });
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(queue.context());
+    if(it != cache_.end())
+      return it->second;
+  }
+  //Loading may calibrate the device, so it runs outside the lock, as in reload()
+  std::time_t time = mtime(user_profile(queue.device()));
+  std::shared_ptr<map_type> map = load(queue);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cache_.find(queue.context());
   if(it == cache_.end())
-    return init(queue);
+  {
+    it = cache_.insert(std::make_pair(queue.context(), map)).first;
+    sources_[queue.context()] = source{time, std::chrono::steady_clock::now()};
+  }
   return it->second;
 }
 
+//Copy-on-write, so that snapshots taken before are left untouched
 void profiles::set(driver::CommandQueue const & queue, expression_type operation, numeric_type dtype, std::shared_ptr<value_type> const & profile)
-{ cache_[queue][std::make_pair(operation,dtype)] = profile; }
+{
+  std::shared_ptr<map_type> map = std::make_shared<map_type>(*snapshot(queue));
+  (*map)[std::make_pair(operation,dtype)] = profile;
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_[queue.context()] = map;
+}
+
+//The new profiles are built aside, then swapped in
+void profiles::reload(driver::CommandQueue const & queue)
+{
+  std::time_t time = mtime(user_profile(queue.device()));
+  std::shared_ptr<map_type> map = load(queue);
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_[queue.context()] = map;
+  sources_[queue.context()] = source{time, std::chrono::steady_clock::now()};
+}
+
+void profiles::watch(bool enabled)
+{ watch_ = enabled; }
+
+void profiles::set_roofline_weight(double weight)
+{ roofline_weight_ = weight; }
+
+std::string profiles::identifier(driver::Device const & device)
+{
+  std::string result = device.vendor_str() + "-" + device.name() + "-" + device.driver_version() + "-" + tools::to_string(device.compute_units()) + "cu";
+  //Safe as a file name
+  for(char & c: result)
+    if(!std::isalnum((unsigned char)c) && c!='.' && c!='-')
+      c = '_';
+  return result;
+}
+
+std::string profiles::path(driver::Device const & device)
+{
+  std::string directory = directory_.size()?directory_:default_directory();
+  return directory.empty()?"":directory + "/" + identifier(device) + ".json";
+}
+
+void profiles::set_directory(std::string const & directory)
+{ directory_ = directory; }
+
+void profiles::save(driver::CommandQueue const & queue, std::string const & filename)
+{
+  std::lock_guard<std::recursive_mutex> lock(execution_mutex(queue.context()));
+  std::shared_ptr<map_type> map = snapshot(queue);
+  std::string fname = filename.size()?filename:path(queue.device());
+  if(fname.empty())
+    throw std::runtime_error("No profile directory: set HOME or ISAAC_PROFILES_DIR");
+  tools::mkpath(fname);
+  std::ostringstream os;
+  os << "{\"version\": " << FORMAT_VERSION;
+  std::string separator = ", ";
+  for(expression_type operation: {ELEMENTWISE_1D, REDUCE_1D, ELEMENTWISE_2D, REDUCE_2D_ROWS, REDUCE_2D_COLS, GEMM_NN, GEMM_TN, GEMM_NT, GEMM_TT})
+  {
+    std::ostringstream entries;
+    for(numeric_type dtype: {FLOAT_TYPE, DOUBLE_TYPE})
+    {
+      map_type::const_iterator it = map->find(std::make_pair(operation, dtype));
+      if(it==map->end())
+        continue;
+      value_type const & profile = *it->second;
+      entries << (entries.tellp()>0?", ":"") << "\"" << ((dtype==FLOAT_TYPE)?"float32":"float64") << "\": {\"profiles\": [";
+      for(size_t i = 0 ; i < profile.templates().size() ; ++i)
+      {
+        std::vector<int> parameters = profile.templates()[i]->parameters();
+        entries << (i?", ":"");
+        if(parameters.empty())
+          entries << "\"cublas_gemm\"";
+        else
+          tools::write_array(entries, parameters);
+      }
+      entries << "]";
+      if(profile.predictor())
+      {
+        entries << ", \"predictor_type\": \"" << profile.predictor()->type() << "\", \"predictor\": ";
+        profile.predictor()->write(entries);
+      }
+      entries << ", \"labels\": [";
+      size_t k = 0;
+      for(auto const & x: profile.labels())
+      {
+        entries << (k++?", ":"") << "{\"sizes\": ";
+        tools::write_array(entries, x.first);
+        entries << ", \"template\": " << x.second << "}";
+      }
+      entries << "], \"roofline\": " << profile.roofline() << "}";
+    }
+    if(entries.tellp()>0)
+    {
+      os << separator << "\"" << to_string(operation) << "\": {" << entries.str() << "}";
+      separator = ", ";
+    }
+  }
+  os << "}" << std::endl;
+  //Written aside then renamed, so that a watcher never reads half a file
+  std::string tmp = fname + ".tmp";
+  {
+    std::ofstream ofs(tmp);
+    if(!(ofs << os.str()))
+      throw std::runtime_error("Could not write " + tmp);
+  }
+  if(std::rename(tmp.c_str(), fname.c_str())!=0)
+    throw std::runtime_error("Could not write " + fname);
+}
+
+void profiles::retrain(driver::CommandQueue const & queue, expression_type operation, numeric_type dtype, predictors::trainer::options_type const & options, bool extend)
+{
+  std::lock_guard<std::recursive_mutex> lock(execution_mutex(queue.context()));
+  std::shared_ptr<map_type> map = snapshot(queue);
+  map_type::const_iterator it = map->find(std::make_pair(operation, dtype));
+  if(it==map->end())
+    throw std::out_of_range("No profile for " + to_string(operation));
+  value_type const & profile = *it->second;
+  predictors::trainer trainer(profile.templates().size(), options);
+  for(auto const & x: profile.measurements())
+    trainer.add(x.first, x.second);
+  predictors::base const * prior = profile.predictor().get();
+  predictors::random_forest const * forest = dynamic_cast<predictors::random_forest const *>(prior);
+  std::shared_ptr<predictors::base> predictor;
+  if(extend && forest && options.model=="random_forest")
+    predictor = std::make_shared<predictors::random_forest>(trainer.extend(*forest));
+  else
+    predictor = trainer.fit(prior);
+  set(queue, operation, dtype, std::make_shared<value_type>(profile, predictor));
+}
+
+void profiles::set_calibration(bool enabled)
+{ calibration_ = enabled; }
 
 void profiles::release()
-{ cache_.clear(); }
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+  sources_.clear();
+}
+
+void profiles::release(driver::Context const & context)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.erase(context);
+  sources_.erase(context);
+}
 
-std::map<driver::CommandQueue, profiles::map_type> profiles::cache_;
+std::map<driver::Context, std::shared_ptr<profiles::map_type> > profiles::cache_;
+std::map<driver::Context, profiles::source> profiles::sources_;
+std::mutex profiles::mutex_;
+bool profiles::watch_ = tools::getenv("ISAAC_PROFILES_WATCH")=="1";
+double profiles::roofline_weight_ = tools::getenv<double>("ISAAC_ROOFLINE_WEIGHT", .5);
+bool profiles::calibration_ = tools::getenv("ISAAC_CALIBRATION")!="0";
+std::string profiles::directory_;
 
 }
 }
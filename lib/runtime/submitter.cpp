@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include "isaac/runtime/submitter.h"
+#include "isaac/runtime/execute.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+submitter::submitter(size_t capacity) : ring_(capacity), sleeping_(false), stop_(false), thread_(&submitter::run, this)
+{ }
+
+submitter::~submitter()
+{
+  synchronize();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeup_.notify_one();
+  thread_.join();
+}
+
+std::future<void> submitter::push(command * cmd)
+{
+  std::future<void> result = cmd->promise.get_future();
+  //Back-pressure when the submission thread lags behind
+  while(!ring_.push(cmd))
+    std::this_thread::yield();
+  //Pairs with the fence in run(): either the consumer sees the command, or we see it asleep
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if(sleeping_)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeup_.notify_one();
+  }
+  return result;
+}
+
+std::future<void> submitter::submit(execution_handler const & handler)
+{
+  std::shared_ptr<execution_handler> copy = std::make_shared<execution_handler>(handler);
+  return submit([copy]{ execute(*copy); });
+}
+
+std::future<void> submitter::submit(std::function<void()> const & task)
+{
+  command * cmd = new command;
+  cmd->task = task;
+  return push(cmd);
+}
+
+void submitter::synchronize()
+{ push(new command).wait(); }
+
+void submitter::run()
+{
+  static const int SPIN = 4096;
+  command * cmd;
+  while(true)
+  {
+    //Spin for a while before going to sleep, since commands tend to come in bursts
+    int spin = 0;
+    while(!ring_.pop(cmd))
+    {
+      if(++spin < SPIN)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex_);
+      sleeping_ = true;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      wakeup_.wait(lock, [&]{ return stop_ || !ring_.empty(); });
+      sleeping_ = false;
+      if(stop_ && ring_.empty())
+        return;
+      spin = 0;
+    }
+    std::unique_ptr<command> guard(cmd);
+    try{
+      if(cmd->task)
+        cmd->task();
+      cmd->promise.set_value();
+    }catch(...){
+      cmd->promise.set_exception(std::current_exception());
+    }
+  }
+}
+
+submitter & submitter::get()
+{
+  static submitter result;
+  return result;
+}
+
+std::future<void> execute_async(execution_handler const & handler)
+{ return submitter::get().submit(handler); }
+
+}
+}
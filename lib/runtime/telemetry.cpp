@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "isaac/runtime/telemetry.h"
+#include "isaac/tools/sys/getenv.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+
+namespace
+{
+  int_t round_up(int_t x)
+  {
+    int_t result = 1;
+    while(result < x)
+      result *= 2;
+    return (x<=0)?x:result;
+  }
+
+  std::string dtype_name(numeric_type dtype)
+  {
+    switch(dtype)
+    {
+      case FLOAT_TYPE: return "float32";
+      case DOUBLE_TYPE: return "float64";
+      default: return to_string(dtype);
+    }
+  }
+
+  //JSON has no infinity: templates that failed are null
+  void write_time(std::ostream & os, double x)
+  {
+    if(std::isinf(x)) os << "null";
+    else os << x;
+  }
+
+  double ratio(double x, size_t n)
+  { return n?x/n:0; }
+}
+
+telemetry::entry::entry() : tunings(0), hits(0), failures(0), regret(0), max_regret(0), rank(0)
+{ }
+
+telemetry::key_type telemetry::key(expression_type operation, numeric_type dtype, std::vector<int_t> const & features)
+{
+  std::vector<int_t> bucket(features.size());
+  std::transform(features.begin(), features.end(), bucket.begin(), round_up);
+  return std::make_tuple(operation, dtype, bucket);
+}
+
+void telemetry::record(expression_type operation, numeric_type dtype, std::vector<int_t> const & features,
+                       std::vector<int> const & ranking, std::vector<double> const & times)
+{
+  if(times.empty())
+    return;
+  size_t best = std::distance(times.begin(), std::min_element(times.begin(), times.end()));
+  std::lock_guard<std::mutex> lock(mutex_);
+  entry & x = entries_[key(operation, dtype, features)];
+  x.tunings++;
+  x.hits += (best==0 && !std::isinf(times[0]));
+  x.rank += best;
+  if(std::isinf(times[0]))
+    x.failures++;
+  else
+  {
+    double regret = times[0]/times[best] - 1;
+    x.regret += regret;
+    x.max_regret = std::max(x.max_regret, regret);
+  }
+  x.ranking = ranking;
+  x.times = times;
+}
+
+void telemetry::sample(expression_type operation, numeric_type dtype, std::vector<int_t> const & features, int label, double time)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::pair<size_t, double> & x = entries_[key(operation, dtype, features)].samples[label];
+  x.first++;
+  x.second += time;
+}
+
+bool telemetry::sampling()
+{
+  size_t period = period_;
+  return period && (counter_++ % period)==0;
+}
+
+void telemetry::set_period(size_t period)
+{ period_ = period; }
+
+std::map<telemetry::key_type, telemetry::entry> telemetry::get()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_;
+}
+
+void telemetry::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+//Entries come by decreasing total regret, so that the worst predicted shapes come first
+void telemetry::dump(std::string const & filename)
+{
+  std::map<key_type, entry> entries = get();
+  std::vector<std::pair<key_type, entry> > sorted(entries.begin(), entries.end());
+  std::stable_sort(sorted.begin(), sorted.end(), [](std::pair<key_type, entry> const & a, std::pair<key_type, entry> const & b)
+                   { return a.second.regret > b.second.regret; });
+  entry total;
+  for(auto const & x: sorted)
+  {
+    total.tunings += x.second.tunings;
+    total.hits += x.second.hits;
+    total.failures += x.second.failures;
+    total.regret += x.second.regret;
+    total.max_regret = std::max(total.max_regret, x.second.max_regret);
+  }
+  std::ostringstream os;
+  os.precision(std::numeric_limits<double>::digits10);
+  os << "{" << std::endl;
+  os << "  \"summary\": {\"tunings\": " << total.tunings << ", \"hit_rate\": " << ratio(total.hits, total.tunings)
+     << ", \"failures\": " << total.failures << ", \"mean_regret\": " << ratio(total.regret, total.tunings - total.failures)
+     << ", \"max_regret\": " << total.max_regret << "}," << std::endl;
+  os << "  \"entries\": [";
+  for(size_t i = 0 ; i < sorted.size() ; ++i)
+  {
+    key_type const & k = sorted[i].first;
+    entry const & x = sorted[i].second;
+    os << (i?",":"") << std::endl << "    {\"operation\": \"" << to_string(std::get<0>(k)) << "\", \"dtype\": \"" << dtype_name(std::get<1>(k)) << "\", \"bucket\": [";
+    for(size_t j = 0 ; j < std::get<2>(k).size() ; ++j)
+      os << (j?", ":"") << std::get<2>(k)[j];
+    os << "], \"tunings\": " << x.tunings << ", \"hit_rate\": " << ratio(x.hits, x.tunings) << ", \"failures\": " << x.failures
+       << ", \"mean_regret\": " << ratio(x.regret, x.tunings - x.failures) << ", \"max_regret\": " << x.max_regret
+       << ", \"mean_rank\": " << ratio(x.rank, x.tunings) << ", \"ranking\": [";
+    for(size_t j = 0 ; j < x.ranking.size() ; ++j)
+      os << (j?", ":"") << x.ranking[j];
+    os << "], \"times\": [";
+    for(size_t j = 0 ; j < x.times.size() ; ++j)
+    {
+      os << (j?", ":"");
+      write_time(os, x.times[j]);
+    }
+    os << "], \"samples\": [";
+    size_t j = 0;
+    for(auto const & s: x.samples)
+      os << (j++?", ":"") << "{\"template\": " << s.first << ", \"count\": " << s.second.first << ", \"mean_time\": " << ratio(s.second.second, s.second.first) << "}";
+    os << "]}";
+  }
+  os << std::endl << "  ]" << std::endl << "}" << std::endl;
+  std::ofstream ofs(filename);
+  if(!(ofs << os.str()))
+    throw std::runtime_error("Could not write " + filename);
+}
+
+std::map<telemetry::key_type, telemetry::entry> telemetry::entries_;
+std::mutex telemetry::mutex_;
+std::atomic<size_t> telemetry::period_(tools::getenv<size_t>("ISAAC_TELEMETRY_PERIOD", 0));
+std::atomic<size_t> telemetry::counter_(0);
+
+namespace
+{
+  //Destroyed before the entries, which are defined above
+  struct dump_at_exit
+  {
+    ~dump_at_exit()
+    {
+      std::string filename = tools::getenv("ISAAC_TELEMETRY_DUMP");
+      if(filename.empty())
+        return;
+      try{
+        telemetry::dump(filename);
+      }catch(std::exception const &){ }
+    }
+  } dump_at_exit_;
+}
+
+}
+}
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "isaac/driver/program_cache.h"
+#include "isaac/runtime/execute.h"
+#include "isaac/runtime/planner.h"
+#include "isaac/runtime/profiles.h"
+#include "isaac/runtime/tuner.h"
+#include "isaac/tools/cpp/timer.hpp"
+
+namespace isaac
+{
+namespace runtime
+{
+
+namespace
+{
+  //Candidates tried, valid or not, per candidate benchmarked. Bounds the search when most of the space is invalid
+  const size_t MAX_ATTEMPTS_PER_EVALUATION = 1000;
+
+  std::vector<int> decode(std::vector<int> const & genome)
+  {
+    std::vector<int> result(genome.size());
+    for(size_t i = 0 ; i < genome.size() ; ++i)
+      result[i] = 1 << genome[i];
+    return result;
+  }
+}
+
+/** @brief Largest exponent of each parameter, in the order of the constructors */
+std::vector<int> const & tuner::bounds(expression_type type)
+{
+  static const std::vector<int> vector = {3, 10, 12};                   //vwidth, ls, ng
+  static const std::vector<int> matrix = {3, 8, 8, 10, 10};             //vwidth, ls0, ls1, ng0, ng1
+  static const std::vector<int> gemm = {3, 6, 6, 6, 4, 4, 3, 4, 6, 6};  //vwidth, ls0, kL, ls1, depth, ms, ks, ns, lf0, lf1
+  switch(type)
+  {
+    case ELEMENTWISE_1D: case REDUCE_1D: return vector;
+    case ELEMENTWISE_2D: case REDUCE_2D_ROWS: case REDUCE_2D_COLS: return matrix;
+    case GEMM_NN: case GEMM_TN: case GEMM_NT: case GEMM_TT: return gemm;
+    default: throw std::invalid_argument("Unrecognized expression type");
+  }
+}
+
+tuner::genome_type tuner::encode(std::vector<int> const & parameters, std::vector<int> const & bounds)
+{
+  genome_type result(parameters.size());
+  for(size_t i = 0 ; i < parameters.size() ; ++i)
+    result[i] = std::min(bounds[i], std::max(0, (int)std::round(std::log2(std::max(parameters[i], 1)))));
+  return result;
+}
+
+tuner::genome_type tuner::random(std::vector<int> const & bounds)
+{
+  genome_type result(bounds.size());
+  for(size_t i = 0 ; i < bounds.size() ; ++i)
+    result[i] = std::uniform_int_distribution<int>(0, bounds[i])(generator_);
+  return result;
+}
+
+//Two-point crossover
+tuner::genome_type tuner::crossover(genome_type const & x, genome_type const & y)
+{
+  std::uniform_int_distribution<size_t> point(0, x.size());
+  size_t first = point(generator_), last = point(generator_);
+  if(first > last)
+    std::swap(first, last);
+  genome_type result = x;
+  std::copy(y.begin() + first, y.begin() + last, result.begin() + first);
+  return result;
+}
+
+//Moves each exponent with probability 1/n, and at least one of them, by one or two steps
+tuner::genome_type tuner::mutate(genome_type x, std::vector<int> const & bounds)
+{
+  std::uniform_real_distribution<double> coin(0, 1);
+  std::uniform_int_distribution<int> step(1, 2);
+  size_t forced = std::uniform_int_distribution<size_t>(0, x.size() - 1)(generator_);
+  for(size_t i = 0 ; i < x.size() ; ++i)
+    if(i==forced || coin(generator_) < 1./x.size())
+    {
+      int delta = (coin(generator_) < .5)?-step(generator_):step(generator_);
+      x[i] = std::min(bounds[i], std::max(0, x[i] + delta));
+    }
+  return x;
+}
+
+double tuner::benchmark(templates::base & tp, expression_tree const & tree, driver::CommandQueue & queue)
+{
+  driver::Context const & context = tree.context();
+  try{
+    //Candidates are not worth a place in the disk cache
+    driver::Program program = driver::ProgramCache::compile(context, tp.generate("0", tree, context.device()), false);
+    execution_handler handler(tree, execution_options_type(queue));
+    tools::Timer tmr;
+    double total = 0, best = INFINITY;
+    while(total < 1e-2){
+      tmr.start();
+      tp.enqueue(queue, program, "0", handler);
+      queue.synchronize();
+      double time = 1e-9*tmr.get().count();
+      best = std::min(best, time);
+      total += time;
+    }
+    return best;
+  }catch(...){
+    return INFINITY;
+  }
+}
+
+tuner::tuner(options_type const & options) : options_(options), generator_(options.seed)
+{ }
+
+tuner::result_type tuner::run(expression_tree const & x, driver::CommandQueue & queue)
+{
+  expression_tree tree = x;
+  detail::optimize(tree);
+  execution_plan plan = planner::make(tree);
+  if(plan.temporaries.size())
+    throw std::invalid_argument("Only expressions evaluated by a single kernel can be tuned");
+  driver::Device const & device = queue.device();
+  std::string name = to_string(plan.final.type);
+  std::vector<int> const & range = bounds(plan.final.type);
+
+  result_type result;
+  result.type = plan.final.type;
+  result.dtype = tree[tree.root()].dtype;
+  result.sizes = profiles::create(name, decode(genome_type(range.size(), 0)))->input_features(tree);
+  result.time = INFINITY;
+  result.evaluations = 0;
+
+  tools::Timer timer(true);
+  size_t attempts = 0;
+  std::map<genome_type, double> cache;
+  std::vector<std::pair<double, genome_type> > population;
+  auto exhausted = [&](){
+    return result.evaluations >= options_.budget || attempts >= MAX_ATTEMPTS_PER_EVALUATION*options_.budget
+           || (options_.seconds > 0 && 1e-9*timer.get().count() > options_.seconds);
+  };
+  auto evaluate = [&](genome_type const & genome){
+    attempts++;
+    if(cache.find(genome)!=cache.end())
+      return;
+    double & time = cache[genome];
+    time = INFINITY;
+    std::vector<int> parameters = decode(genome);
+    std::shared_ptr<templates::base> tp = profiles::create(name, parameters);
+    if(tp->is_invalid(tree, device)!=templates::TEMPLATE_VALID || tp->temporary_workspace(tree) > profiles::MAX_TEMPORARY_WORKSPACE)
+      return;
+    if(options_.prefilter && tp->is_implausible(tree, device)!=templates::TEMPLATE_VALID)
+      return;
+    result.evaluations++;
+    time = benchmark(*tp, tree, queue);
+    if(time==INFINITY)
+      return;
+    population.push_back(std::make_pair(time, genome));
+    if(time < result.time){
+      result.time = time;
+      result.parameters = parameters;
+    }
+  };
+
+  //Seeds: a random subset of the templates of the current profile
+  std::shared_ptr<profiles::map_type> map = profiles::snapshot(queue);
+  profiles::map_type::const_iterator it = map->find(std::make_pair(result.type, result.dtype));
+  if(it!=map->end())
+  {
+    std::vector<std::vector<int> > seeds;
+    for(auto const & tp: it->second->templates())
+      if(tp->type()==result.type && tp->parameters().size()==range.size())
+        seeds.push_back(tp->parameters());
+    std::shuffle(seeds.begin(), seeds.end(), generator_);
+    for(size_t i = 0 ; i < std::min(seeds.size(), options_.population) && !exhausted() ; ++i)
+      evaluate(encode(seeds[i], range));
+  }
+  while(population.size() < options_.population && !exhausted())
+    evaluate(random(range));
+
+  //Steady-state evolution with binary tournaments
+  std::uniform_real_distribution<double> coin(0, 1);
+  auto select = [&]() -> genome_type const & {
+    std::uniform_int_distribution<size_t> pick(0, population.size() - 1);
+    return population[std::min(pick(generator_), pick(generator_))].second;
+  };
+  while(population.size() && !exhausted())
+  {
+    std::sort(population.begin(), population.end());
+    if(population.size() > options_.population)
+      population.resize(options_.population);
+    double r = coin(generator_);
+    if(r < .4 && population.size() > 1)
+      evaluate(crossover(select(), select()));
+    else if(r < .9)
+      evaluate(mutate(select(), range));
+    else
+      evaluate(random(range));
+  }
+  //The fallback gets what remains of the budget and of the time limit
+  double elapsed = 1e-9*timer.get().count();
+  if(result.parameters.empty() && options_.prefilter && result.evaluations < options_.budget
+     && (options_.seconds <= 0 || elapsed < options_.seconds))
+  {
+    options_type options = options_;
+    options.prefilter = false;
+    options.budget -= result.evaluations;
+    if(options_.seconds > 0)
+      options.seconds -= elapsed;
+    result_type fallback = tuner(options).run(x, queue);
+    fallback.evaluations += result.evaluations;
+    return fallback;
+  }
+  return result;
+}
+
+void tuner::apply(result_type const & result, driver::CommandQueue const & queue)
+{
+  if(result.parameters.empty())
+    throw std::invalid_argument("The tuner found no valid template");
+  std::lock_guard<std::recursive_mutex> lock(execution_mutex(queue.context()));
+  std::shared_ptr<profiles::map_type> map = profiles::snapshot(queue);
+  profiles::map_type::const_iterator it = map->find(std::make_pair(result.type, result.dtype));
+  if(it==map->end())
+    throw std::out_of_range("No profile for " + to_string(result.type));
+  auto const & templates = it->second->templates();
+  for(size_t i = 0 ; i < templates.size() ; ++i)
+    if(templates[i]->type()==result.type && templates[i]->parameters()==result.parameters)
+    {
+      it->second->set_label(result.sizes, (int)i);
+      it->second->record(result.sizes, (int)i, result.time);
+      return;
+    }
+  std::shared_ptr<profiles::value_type> profile = std::make_shared<profiles::value_type>(*it->second, profiles::create(to_string(result.type), result.parameters));
+  profile->set_label(result.sizes, (int)templates.size());
+  profile->record(result.sizes, (int)templates.size(), result.time);
+  profiles::set(queue, result.type, result.dtype, profile);
+}
+
+}
+}
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2015, PHILIPPE TILLET. All rights reserved.
+ *
+ * This file is part of ISAAC.
+ *
+ * ISAAC is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301  USA
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "isaac/array.h"
+#include "isaac/driver/program_cache.h"
+#include "isaac/jit/generation/base.h"
+#include "isaac/runtime/execute.h"
+#include "isaac/runtime/profiles.h"
+#include "isaac/runtime/warmup.h"
+
+namespace isaac
+{
+namespace runtime
+{
+
+namespace
+{
+  const char MAGIC[8] = {'I','S','A','A','C','B','D','L'};
+  //Version 2: labels are keyed by the input features rather than by the input sizes
+  //Version 3: one binary per device of the context
+  const uint64_t VERSION = 3;
+
+  const std::vector<expression_type> all_operations = {ELEMENTWISE_1D, REDUCE_1D, ELEMENTWISE_2D, REDUCE_2D_ROWS, REDUCE_2D_COLS,
+                                                   GEMM_NN, GEMM_TN, GEMM_NT, GEMM_TT};
+  const std::vector<numeric_type> all_dtypes = {FLOAT_TYPE, DOUBLE_TYPE};
+
+  void write(std::ostream & os, uint64_t x)
+  { os.write((char const *)&x, sizeof(x)); }
+
+  void write(std::ostream & os, std::string const & x)
+  {
+    write(os, (uint64_t)x.size());
+    os.write(x.data(), std::streamsize(x.size()));
+  }
+
+  uint64_t read_uint(std::istream & is)
+  {
+    uint64_t result;
+    if(!is.read((char*)&result, sizeof(result)))
+      throw std::runtime_error("Truncated kernel bundle");
+    return result;
+  }
+
+  std::string read_string(std::istream & is)
+  {
+    std::string result(read_uint(is), '\0');
+    if(!is.read(&result[0], std::streamsize(result.size())))
+      throw std::runtime_error("Truncated kernel bundle");
+    return result;
+  }
+
+  /** @brief Binaries are only portable across identical devices, drivers and generators */
+  std::string identity(driver::Device const & device)
+  {
+    driver::Platform platform = device.platform();
+    return device.name() + "|" + device.vendor_str() + "|" + platform.name() + "|" + platform.version() + "|" + device.driver_version()
+           + "|" ISAAC_VERSION "|" + templates::base::generator_id();
+  }
+
+  /** @brief Programs are built and loaded for the device of their context, which is the first one of OpenCL contexts */
+  driver::Device const & bundle_device(driver::CommandQueue const & queue)
+  {
+    if(queue.device()!=queue.context().device())
+      throw std::runtime_error("Bundles only hold binaries for the first device of a context");
+    return queue.device();
+  }
+
+  void run(expression_tree const & tree, driver::CommandQueue & queue)
+  { execute(execution_handler(tree, execution_options_type(queue))); }
+}
+
+void warmup(std::vector<expression_tree> const & working_set, driver::CommandQueue & queue)
+{
+  for(expression_tree const & tree: working_set)
+    run(tree, queue);
+  queue.synchronize();
+}
+
+void warmup(std::vector<expression_type> const & operations, std::vector<numeric_type> const & dtypes,
+            std::vector<std::vector<int_t> > const & shapes, driver::CommandQueue & queue)
+{
+  driver::Context const & context = queue.context();
+  for(numeric_type dtype: dtypes)
+  {
+    value_scalar alpha(2., dtype), beta(3., dtype);
+    for(std::vector<int_t> const & shape: shapes)
+      for(expression_type operation: operations)
+      {
+        int_t M = shape.size()>0?shape[0]:0, N = shape.size()>1?shape[1]:0, K = shape.size()>2?shape[2]:0;
+        switch(operation)
+        {
+          case ELEMENTWISE_1D:
+          {
+            if(!M) break;
+            array x(M, dtype, context), y(M, dtype, context);
+            run(assign(y, alpha*x + y), queue);
+            break;
+          }
+          case REDUCE_1D:
+          {
+            if(!M) break;
+            array x(M, dtype, context), y(M, dtype, context);
+            scalar s(dtype, context);
+            run(assign(s, dot(x, y)), queue);
+            break;
+          }
+          case ELEMENTWISE_2D:
+          {
+            if(!N) break;
+            array A(M, N, dtype, context), B(M, N, dtype, context);
+            run(assign(B, alpha*A + B), queue);
+            break;
+          }
+          case REDUCE_2D_ROWS:
+          {
+            if(!N) break;
+            array A(M, N, dtype, context), x(N, dtype, context), y(M, dtype, context);
+            run(assign(y, alpha*dot(A, x) + beta*y), queue);
+            break;
+          }
+          case REDUCE_2D_COLS:
+          {
+            if(!N) break;
+            array A(M, N, dtype, context), x(M, dtype, context), y(N, dtype, context);
+            run(assign(y, alpha*dot(A.T, x) + beta*y), queue);
+            break;
+          }
+          case GEMM_NN: case GEMM_TN: case GEMM_NT: case GEMM_TT:
+          {
+            if(!K) break;
+            bool AT = operation==GEMM_TN || operation==GEMM_TT;
+            bool BT = operation==GEMM_NT || operation==GEMM_TT;
+            array A(AT?K:M, AT?M:K, dtype, context), B(BT?N:K, BT?K:N, dtype, context), C(M, N, dtype, context);
+            if(AT && BT) run(assign(C, alpha*dot(A.T, B.T) + beta*C), queue);
+            else if(AT)  run(assign(C, alpha*dot(A.T, B) + beta*C), queue);
+            else if(BT)  run(assign(C, alpha*dot(A, B.T) + beta*C), queue);
+            else         run(assign(C, alpha*dot(A, B) + beta*C), queue);
+            break;
+          }
+          default:
+            break;
+        }
+      }
+  }
+  queue.synchronize();
+}
+
+void warmup(std::vector<expression_type> const & operations, std::vector<numeric_type> const & dtypes,
+            std::vector<std::vector<int_t> > const & shapes)
+{ warmup(operations, dtypes, shapes, driver::backend::queues::get(driver::backend::contexts::get_default())); }
+
+void export_bundle(std::string const & filename, driver::CommandQueue const & queue)
+{
+  std::lock_guard<std::recursive_mutex> lock(execution_mutex(queue.context()));
+  std::shared_ptr<profiles::map_type> map = profiles::snapshot(queue);
+  std::ofstream os(filename, std::ios::binary);
+  if(!os)
+    throw std::runtime_error("Could not open " + filename);
+  os.write(MAGIC, sizeof(MAGIC));
+  write(os, VERSION);
+  write(os, identity(bundle_device(queue)));
+  write(os, (uint64_t)(all_operations.size()*all_dtypes.size()));
+  for(expression_type operation: all_operations)
+    for(numeric_type dtype: all_dtypes)
+    {
+      write(os, (uint64_t)operation);
+      write(os, (uint64_t)dtype);
+      //Programs
+      std::map<std::string, driver::Program> const & programs = driver::backend::programs::get(queue.context(), operation, dtype).programs();
+      write(os, (uint64_t)programs.size());
+      for(auto const & x: programs)
+      {
+        write(os, x.first);
+        std::vector<std::string> binaries = x.second.binaries();
+        write(os, (uint64_t)binaries.size());
+        for(std::string const & binary: binaries)
+          write(os, binary);
+      }
+      //Labels
+      profiles::map_type::const_iterator it = map->find(std::make_pair(operation, dtype));
+      std::map<std::vector<int_t>, int> labels;
+      if(it!=map->end())
+        labels = it->second->labels();
+      write(os, (uint64_t)labels.size());
+      for(auto const & x: labels)
+      {
+        write(os, (uint64_t)x.first.size());
+        for(int_t size: x.first)
+          write(os, (uint64_t)size);
+        write(os, (uint64_t)x.second);
+      }
+    }
+}
+
+void import_bundle(std::string const & filename, driver::CommandQueue const & queue)
+{
+  //Programs are named after the templates of the profiles, which must match those of the exporter
+  std::lock_guard<std::recursive_mutex> lock(execution_mutex(queue.context()));
+  std::shared_ptr<profiles::map_type> map = profiles::snapshot(queue);
+  driver::Context const & context = queue.context();
+  std::ifstream is(filename, std::ios::binary);
+  if(!is)
+    throw std::runtime_error("Could not open " + filename);
+  char magic[sizeof(MAGIC)];
+  if(!is.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC) || read_uint(is)!=VERSION)
+    throw std::runtime_error(filename + " is not a kernel bundle of this version");
+  if(read_string(is)!=identity(bundle_device(queue)))
+    throw std::runtime_error(filename + " was built for another device or driver");
+  for(uint64_t n = read_uint(is) ; n > 0 ; --n)
+  {
+    expression_type operation = (expression_type)read_uint(is);
+    numeric_type dtype = (numeric_type)read_uint(is);
+    driver::ProgramCache & cache = driver::backend::programs::get(queue.context(), operation, dtype);
+    for(uint64_t k = read_uint(is) ; k > 0 ; --k)
+    {
+      std::string name = read_string(is);
+      std::vector<std::string> binaries(read_uint(is));
+      for(std::string & binary: binaries)
+        binary = read_string(is);
+      cache.add(name, driver::Program::load(context, binaries));
+    }
+    profiles::map_type::iterator it = map->find(std::make_pair(operation, dtype));
+    for(uint64_t k = read_uint(is) ; k > 0 ; --k)
+    {
+      std::vector<int_t> sizes(read_uint(is));
+      for(int_t & size: sizes)
+        size = (int_t)read_uint(is);
+      int label = (int)read_uint(is);
+      if(it!=map->end())
+        it->second->set_label(sizes, label);
+    }
+  }
+}
+
+}
+}
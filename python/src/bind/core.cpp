@@ -25,6 +25,9 @@
 
 namespace tpt = sc::templates;
 
+queue_profiles::queue_profiles(sc::driver::CommandQueue const & _queue) : queue(_queue), map(rt::profiles::snapshot(_queue))
+{ }
+
 namespace detail
 {
 
@@ -217,12 +220,12 @@ namespace detail
 
   struct model_map_indexing
   {
-      static rt::profiles::value_type& get_item(rt::profiles::map_type& container, bp::tuple i_)
+      static rt::profiles::value_type& get_item(queue_profiles& container, bp::tuple i_)
       {
           tpt::base* tpt =  bp::extract<tpt::base*>(i_[0]);
           sc::numeric_type dtype = tools::extract_dtype(i_[1]);
-          rt::profiles::map_type::iterator i = container.find(std::make_pair(tpt->type(), dtype));
-          if (i == container.end())
+          rt::profiles::map_type::iterator i = container.map->find(std::make_pair(tpt->type(), dtype));
+          if (i == container.map->end())
           {
               PyErr_SetString(PyExc_KeyError, "Invalid key");
               bp::throw_error_already_set();
@@ -230,11 +233,12 @@ namespace detail
           return *i->second;
       }
 
-      static void set_item(rt::profiles::map_type& container, bp::tuple i_, rt::profiles::value_type const & v)
+      //Copy-on-write, as other threads may be executing on the current profiles
+      static void set_item(queue_profiles& container, bp::tuple i_, rt::profiles::value_type const & v)
       {
           tpt::base* tpt =  bp::extract<tpt::base*>(i_[0]);
           sc::numeric_type dtype = tools::extract_dtype(i_[1]);
-          container[std::make_pair(tpt->type(), dtype)].reset(new rt::profiles::value_type(v));
+          rt::profiles::set(container.queue, tpt->type(), dtype, std::make_shared<rt::profiles::value_type>(v));
       }
   };
 }
@@ -415,8 +419,8 @@ void export_core()
 
   /*--- Profiles----*/
   //---------------------------------------
-  bp::class_<rt::profiles::map_type>("profiles")
+  bp::class_<queue_profiles>("profiles", bp::no_init)
       .def("__getitem__", &detail::model_map_indexing::get_item, bp::return_internal_reference<>())
-      .def("__setitem__", &detail::model_map_indexing::set_item, bp::with_custodian_and_ward<1,2>())
+      .def("__setitem__", &detail::model_map_indexing::set_item)
       ;
 }
@@ -22,6 +22,19 @@
 #ifndef ISAAC_PYTHON_CORE_HPP
 #define ISAAC_PYTHON_CORE_HPP
 
+#include <memory>
+
+#include "isaac/driver/command_queue.h"
+#include "isaac/runtime/profiles.h"
+
+//Profiles of a queue, as they were when obtained. Assignments go through runtime::profiles::set and leave them untouched
+struct queue_profiles
+{
+  queue_profiles(isaac::driver::CommandQueue const & queue);
+  isaac::driver::CommandQueue queue;
+  std::shared_ptr<isaac::runtime::profiles::map_type> map;
+};
+
 void export_core();
 
 #endif
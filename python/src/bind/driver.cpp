@@ -27,6 +27,7 @@
 #include "isaac/runtime/handler.h"
 
 #include "common.hpp"
+#include "core.h"
 #include "driver.h"
 
 
@@ -81,6 +82,9 @@ namespace detail
     throw;
   }
 
+  queue_profiles get_profiles(sc::driver::CommandQueue const & queue)
+  { return queue_profiles(queue); }
+
   std::shared_ptr<sc::driver::Context> make_context(sc::driver::Device const & dev)
   { return std::shared_ptr<sc::driver::Context>(new sc::driver::Context(dev)); }
 
@@ -95,7 +99,7 @@ namespace detail
       sc::expression_tree::node const & root = tree[tree.root()];
       if(sc::is_assignment(root.binary_operator.op.type))
       {
-          rt::execute(rt::execution_handler(tree, execution_options, dispatcher_options, compilation_options), rt::profiles::get(execution_options.queue(tree.context())));
+          rt::execute(rt::execution_handler(tree, execution_options, dispatcher_options, compilation_options), *rt::profiles::snapshot(execution_options.queue(tree.context())));
           sc::expression_tree::node const & lhs = tree[root.binary_operator.lhs];
           sc::driver::Buffer const & data = sc::driver::make_buffer(tree.context().backend(), lhs.array.handle.cl, lhs.array.handle.cu, false);
           std::shared_ptr<sc::array> parray(new sc::array(lhs.shape, lhs.dtype, lhs.array.start, lhs.ld, data));
@@ -174,7 +178,7 @@ void export_driver()
 
   bp::class_<sc::driver::CommandQueue>("command_queue", bp::init<sc::driver::Context const &, sc::driver::Device const &>())
       .def("synchronize", &sc::driver::CommandQueue::synchronize)
-      .add_property("profiles", bp::make_function(&rt::profiles::get, bp::return_internal_reference<>()))
+      .add_property("profiles", &detail::get_profiles)
       .add_property("device", bp::make_function(&sc::driver::CommandQueue::device, bp::return_internal_reference<>()))
       ;
 
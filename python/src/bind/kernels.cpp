@@ -39,6 +39,12 @@ namespace detail
       std::vector<isaac::int_t> tmp = temp.input_sizes(tree);
       return tools::to_list(tmp.begin(), tmp.end());
   }
+
+  bp::list input_features(tpt::base & temp, sc::expression_tree const & tree)
+  {
+      std::vector<isaac::int_t> tmp = temp.input_features(tree);
+      return tools::to_list(tmp.begin(), tmp.end());
+  }
 }
 
 void export_templates()
@@ -55,7 +61,9 @@ void export_templates()
             .def("lmem_usage", &tpt::base::lmem_usage)
             .def("registers_usage", &tpt::base::registers_usage)
             .def("is_invalid", &tpt::base::is_invalid)
+            .def("is_implausible", &tpt::base::is_implausible)
             .def("input_sizes", &detail::input_sizes)
+            .def("input_features", &detail::input_features)
         ;
     #undef __PROP
   }
@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "isaac/driver/disk_cache.h"
+#include "isaac/tools/sys/mkdir.hpp"
+
+namespace drv = isaac::driver;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+  std::string path = "isaac-disk-cache-test/";
+  isaac::tools::mkpath(path);
+  drv::DiskCache(path, 1000).clear();
+
+  #define ADD_TEST(NAME, PRED) \
+  {\
+    std::cout << NAME << "...";\
+    if(!(PRED)){\
+      std::cout << " [Failure!]" << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  std::string binary;
+  {
+    drv::DiskCache cache(path, 25);
+    ADD_TEST("miss", !cache.load("a", binary) && cache.stats().misses==1)
+    cache.store("a", std::string(10, 'a'));
+    ADD_TEST("hit", cache.load("a", binary) && binary==std::string(10, 'a') && cache.stats().hits==1)
+    cache.store("b", std::string(10, 'b'));
+    cache.load("a", binary);
+    cache.store("c", std::string(10, 'c'));
+    ADD_TEST("lru eviction", cache.load("a", binary) && !cache.load("b", binary) && cache.stats().evictions==1 && cache.stats().size==20)
+  }
+  {
+    drv::DiskCache cache(path, 25);
+    ADD_TEST("shared index", cache.load("c", binary) && cache.stats().size==20)
+    std::ofstream(path + "c", std::ios::binary) << "truncated";
+    ADD_TEST("corrupted entry", !cache.load("c", binary) && !cache.load("c", binary))
+    cache.clear();
+    ADD_TEST("clear", !cache.load("a", binary) && cache.stats().size==0)
+  }
+
+  if(nfail>0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
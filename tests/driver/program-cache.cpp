@@ -0,0 +1,52 @@
+#include <iostream>
+#include "isaac/driver/backend.h"
+#include "isaac/driver/program_cache.h"
+#include "isaac/jit/generation/engine/stream.h"
+
+namespace drv = isaac::driver;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+  drv::Context const & context = drv::backend::contexts::get_default();
+  isaac::kernel_generation_stream stream(context.backend());
+  stream << "$KERNEL void k($GLOBAL float* x){ x[0] = 0; }" << std::endl;
+  drv::Program program(context, stream.str(), false);
+
+  #define ADD_TEST(NAME, PRED) \
+  {\
+    std::cout << NAME << "...";\
+    if(!(PRED)){\
+      std::cout << " [Failure!]" << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  drv::ProgramCache cache(2);
+  ADD_TEST("miss", !cache.find("a") && cache.stats().misses==1)
+  cache.add("a", program);
+  cache.add("b", program);
+  ADD_TEST("hit", cache.find("a") && cache.stats().hits==1 && cache.stats().programs==2)
+  cache.add("c", program);
+  ADD_TEST("lru eviction", cache.find("a") && !cache.find("b") && cache.find("c") && cache.stats().evictions==1)
+  ADD_TEST("bytes", cache.stats().bytes==2*program.binary_size())
+  cache.find("a");
+  cache.trim(1);
+  ADD_TEST("trim", cache.find("a") && !cache.find("c") && cache.stats().programs==1 && cache.stats().evictions==2)
+  cache.set_capacity(3);
+  cache.add("b", program);
+  cache.add("c", program);
+  ADD_TEST("capacity", cache.programs().size()==3 && cache.stats().evictions==2)
+  cache.erase("b");
+  ADD_TEST("erase", !cache.find("b") && cache.stats().programs==2 && cache.stats().evictions==2)
+  cache.clear();
+  ADD_TEST("clear", cache.programs().empty() && cache.stats().programs==0 && cache.stats().bytes==0)
+
+  if(nfail>0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include "isaac/runtime/execute.h"
+#include "isaac/jit/syntax/engine/process.h"
+#include "isaac/array.h"
+
+namespace sc = isaac;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+  sc::array A(3, 4), B(4, 3);
+  sc::array y(4), x(4), z(4);
+
+  #define ADD_OPT_TEST(NAME, PRED, SCEXPR) \
+  {\
+    std::cout << NAME << "...";\
+    sc::expression_tree tree = SCEXPR;\
+    sc::runtime::detail::optimize(tree);\
+    sc::expression_tree::node const & rhs = tree[tree[tree.root()].binary_operator.rhs];\
+    if(!(PRED)){\
+      std::cout << " [Failure!]" << std::endl;\
+      std::cout << sc::to_string(tree) << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  /* Algebraic simplification */
+  ADD_OPT_TEST("B = trans(trans(B))", rhs.type==sc::DENSE_ARRAY_TYPE, sc::assign(B, trans(trans(B))))
+  ADD_OPT_TEST("y = 1*x", rhs.type==sc::DENSE_ARRAY_TYPE, sc::assign(y, 1*x))
+  ADD_OPT_TEST("y = pow(x, 2)", rhs.binary_operator.op.type==sc::ELEMENT_PROD_TYPE && rhs.binary_operator.lhs==rhs.binary_operator.rhs,
+               sc::assign(y, pow(x, 2)))
+  ADD_OPT_TEST("y = 2*(3*x)", tree[rhs.binary_operator.lhs].type==sc::VALUE_SCALAR_TYPE && tree[rhs.binary_operator.rhs].type==sc::DENSE_ARRAY_TYPE
+                              && (float)sc::value_scalar(tree[rhs.binary_operator.lhs].scalar, tree[rhs.binary_operator.lhs].dtype)==6,
+               sc::assign(y, 2*(3*x)))
+
+  /* Common subexpressions */
+  ADD_OPT_TEST("y = exp(x) + exp(x)", rhs.binary_operator.lhs==rhs.binary_operator.rhs, sc::assign(y, sc::exp(x) + sc::exp(x)))
+  ADD_OPT_TEST("y = exp(x) + exp(y)", rhs.binary_operator.lhs!=rhs.binary_operator.rhs, sc::assign(y, sc::exp(x) + sc::exp(y)))
+
+  #define ADD_HASH_TEST(NAME, SAME, SCEXPR1, SCEXPR2) \
+  {\
+    std::cout << NAME << "...";\
+    sc::expression_tree x1 = SCEXPR1, x2 = SCEXPR2;\
+    sc::runtime::detail::optimize(x1);\
+    sc::runtime::detail::optimize(x2);\
+    if((sc::symbolic::hash(x1)==sc::symbolic::hash(x2))!=SAME){\
+      std::cout << " [Failure!]" << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  /* Canonical program names */
+  ADD_HASH_TEST("y = exp(x) + y ~ y = y + exp(x)", true, sc::assign(y, sc::exp(x) + y), sc::assign(y, y + sc::exp(x)))
+  ADD_HASH_TEST("y = x*2 ~ y = 2*x", true, sc::assign(y, x*2), sc::assign(y, 2*x))
+  ADD_HASH_TEST("y = x + y ~ y = x + z", true, sc::assign(y, x + y), sc::assign(y, x + z))
+  ADD_HASH_TEST("y = exp(x) - exp(x) !~ y = -exp(x)", false, sc::assign(y, sc::exp(x) - sc::exp(x)), sc::assign(y, -sc::exp(x)))
+
+  if(nfail)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+#include "isaac/runtime/planner.h"
+#include "isaac/array.h"
+
+namespace sc = isaac;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+  sc::array A(512, 512);
+  sc::array y(512), x(512), u(512);
+  //Launches are cheap relative to transcendental recomputation
+  sc::runtime::device_costs fast_launch(200e9, 1e12, 1e-7);
+  //Launches dominate
+  sc::runtime::device_costs slow_launch(200e9, 1e12, 1e-3);
+
+  #define ADD_PLAN_TEST(NAME, COSTS, RESULT_TYPE, NTMP, SCEXPR) \
+  {\
+    std::cout << NAME << "...";\
+    sc::expression_tree tree = SCEXPR;\
+    sc::runtime::execution_plan plan = sc::runtime::planner::make(tree, COSTS);\
+    if(!(plan.final.type == RESULT_TYPE && plan.temporaries.size()==NTMP)){\
+      std::cout << " [Failure!]" << std::endl;\
+      std::cout << sc::runtime::to_string(plan);\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  /* Nothing to recompute */
+  ADD_PLAN_TEST("y = ax + by", fast_launch, sc::ELEMENTWISE_1D, 0, sc::assign(y, 2*x + 3*u))
+  ADD_PLAN_TEST("y = dot(A,x)", fast_launch, sc::REDUCE_2D_ROWS, 0, sc::assign(y, dot(A, x)))
+
+  /* Broadcast subexpression */
+  ADD_PLAN_TEST("y = dot(A,exp(x)) [fast launch]", fast_launch, sc::REDUCE_2D_ROWS, 1, sc::assign(y, dot(A, sc::exp(x))))
+  ADD_PLAN_TEST("y = dot(A,exp(x)) [slow launch]", slow_launch, sc::REDUCE_2D_ROWS, 0, sc::assign(y, dot(A, sc::exp(x))))
+
+  if(nfail)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
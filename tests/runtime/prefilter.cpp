@@ -0,0 +1,39 @@
+#include <iostream>
+#include "isaac/jit/generation/gemm.h"
+#include "isaac/array.h"
+
+namespace sc = isaac;
+namespace tpt = isaac::templates;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+  sc::array A(256, 256), B(256, 256), C(256, 256);
+  //Leading dimension of 255, which 4-wide vectors do not divide
+  sc::array Am(255, 256), Cm(255, 256);
+  sc::driver::Device const & device = A.context().device();
+
+  #define ADD_PREFILTER_TEST(NAME, RESULT, TEMPLATE, SCEXPR) \
+  {\
+    std::cout << NAME << "...";\
+    sc::expression_tree tree = SCEXPR;\
+    int result = TEMPLATE.is_implausible(tree, device);\
+    if(result != RESULT){\
+      std::cout << " [Failure!] " << result << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  //vwidth, ls0, kL, ls1, depth, ms, ks, ns, lf0, lf1
+  if(device.type()==sc::driver::Device::Type::GPU)
+    ADD_PREFILTER_TEST("register spill", tpt::TEMPLATE_REGISTER_SPILL, tpt::gemm_nn(1, 8, 8, 8, 1, 16, 8, 16, 8, 8), sc::assign(C, dot(A, B)))
+  ADD_PREFILTER_TEST("misaligned simd width", tpt::TEMPLATE_MISALIGNED_SIMD_WIDTH, tpt::gemm_nn(4, 8, 8, 8, 1, 4, 4, 4, 8, 8), sc::assign(Cm, dot(Am, B)))
+
+  if(nfail>0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "isaac/runtime/submitter.h"
+#include "isaac/tools/cpp/ring.hpp"
+
+namespace rt = isaac::runtime;
+
+int main()
+{
+  int nfail = 0, npass = 0;
+
+  #define ADD_TEST(NAME, PRED) \
+  {\
+    std::cout << NAME << "...";\
+    if(!(PRED)){\
+      std::cout << " [Failure!]" << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  /* Ring */
+  {
+    isaac::tools::mpsc_ring<int> ring(3);
+    int x;
+    ADD_TEST("ring empty", ring.empty() && !ring.pop(x))
+    bool pushed = ring.push(1) && ring.push(2) && ring.push(3) && ring.push(4);
+    ADD_TEST("ring full", pushed && !ring.push(5))
+    bool fifo = ring.pop(x) && x==1 && ring.pop(x) && x==2 && ring.push(5) && ring.pop(x) && x==3 && ring.pop(x) && x==4 && ring.pop(x) && x==5;
+    ADD_TEST("ring fifo", fifo && ring.empty())
+  }
+  {
+    const int NPRODUCERS = 4, N = 10000;
+    isaac::tools::mpsc_ring<int> ring(64);
+    std::vector<std::thread> producers;
+    for(int p = 0 ; p < NPRODUCERS ; ++p)
+      producers.emplace_back([&ring, p]{
+        for(int i = 0 ; i < N ; ++i)
+          while(!ring.push(p*N + i))
+            std::this_thread::yield();
+      });
+    std::vector<int> last(NPRODUCERS, -1);
+    bool ordered = true;
+    for(int n = 0, x ; n < NPRODUCERS*N ; )
+      if(ring.pop(x)){
+        ordered = ordered && x%N > last[x/N];
+        last[x/N] = x%N;
+        n++;
+      }
+    for(std::thread & t: producers)
+      t.join();
+    ADD_TEST("ring producers", ordered && ring.empty())
+  }
+
+  /* Submitter */
+  {
+    rt::submitter submitter(4);
+    std::vector<int> order;
+    std::vector<std::future<void> > futures;
+    for(int i = 0 ; i < 100 ; ++i)
+      futures.push_back(submitter.submit([&order, i]{ order.push_back(i); }));
+    futures.back().wait();
+    bool ordered = order.size()==100;
+    for(int i = 0 ; i < 100 && ordered ; ++i)
+      ordered = order[i]==i;
+    ADD_TEST("submitter order", ordered)
+    std::future<void> error = submitter.submit([]{ throw std::runtime_error("error"); });
+    bool thrown = false;
+    try{ error.get(); }catch(std::runtime_error const &){ thrown = true; }
+    ADD_TEST("submitter exception", thrown)
+    std::atomic<int> count(0);
+    for(int i = 0 ; i < 10 ; ++i)
+      submitter.submit([&count]{ std::this_thread::sleep_for(std::chrono::milliseconds(1)); count++; });
+    submitter.synchronize();
+    ADD_TEST("submitter synchronize", count==10)
+  }
+
+  if(nfail>0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}
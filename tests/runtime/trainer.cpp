@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include "isaac/runtime/predictors/trainer.h"
+#include "rapidjson/document.h"
+
+namespace pr = isaac::runtime::predictors;
+using isaac::int_t;
+
+namespace
+{
+  size_t argmax(std::vector<float> const & x)
+  { return std::max_element(x.begin(), x.end()) - x.begin(); }
+
+  //Template 0 is best for small inputs, template 2 for large ones
+  pr::trainer make(pr::trainer::options_type const & options)
+  {
+    pr::trainer result(3, options);
+    for(int_t n = 1 ; n <= 16 ; ++n)
+      result.add({n, 7}, (n <= 8)?std::vector<float>{4, 2, 1}:std::vector<float>{1, 2, 4*float(n)});
+    return result;
+  }
+
+  bool ranks(pr::base const & predictor)
+  {
+    for(int_t n = 1 ; n <= 16 ; ++n)
+      if(argmax(predictor.predict({n, 7}))!=((n <= 8)?0:2))
+        return false;
+    return true;
+  }
+
+  bool round_trip(pr::base const & predictor)
+  {
+    std::ostringstream os;
+    predictor.write(os);
+    rapidjson::Document document;
+    document.Parse<0>(os.str().c_str());
+    if(document.HasParseError())
+      return false;
+    std::shared_ptr<pr::base> copy = pr::create(predictor.type(), document);
+    for(int_t n = 1 ; n <= 16 ; ++n)
+    {
+      std::vector<float> x = predictor.predict({n, 7}), y = copy->predict({n, 7});
+      for(size_t j = 0 ; j < x.size() ; ++j)
+        if(std::abs(x[j] - y[j]) > 1e-4*std::max(1.f, std::abs(x[j])))
+          return false;
+    }
+    return true;
+  }
+}
+
+int main()
+{
+  int nfail = 0, npass = 0;
+
+  #define ADD_TEST(NAME, PRED) \
+  {\
+    std::cout << NAME << "...";\
+    if(!(PRED)){\
+      std::cout << " [Failure!]" << std::endl;\
+      nfail++;\
+    }\
+    else{\
+      std::cout << std::endl;\
+      npass++;\
+    }\
+  }
+
+  /* Models */
+  for(std::string model: {"random_forest", "gradient_boosting", "nearest_neighbors"})
+  {
+    pr::trainer trainer = make(pr::trainer::options_type(model, 10, 10, 1, 0, .3f, 3));
+    std::shared_ptr<pr::base> predictor = trainer.fit();
+    ADD_TEST(model + " fit", predictor->type()==model && ranks(*predictor))
+    ADD_TEST(model + " write/read", round_trip(*predictor))
+  }
+  {
+    pr::trainer trainer = make(pr::trainer::options_type("auto"));
+    std::shared_ptr<pr::base> predictor = trainer.fit();
+    ADD_TEST("auto fit", ranks(*predictor))
+  }
+
+  /* Extension of a forest in other units, which prefers template 0 everywhere */
+  {
+    std::vector<pr::random_forest::tree> trees(10, pr::random_forest::tree({-1}, {-1}, {-2}, {-2}, {{4000, 500, 1000}}));
+    pr::random_forest prior(trees);
+    pr::trainer trainer(3);
+    for(int_t n = 1 ; n <= 8 ; ++n)
+      trainer.add({n, 7}, {1, NAN, 3});
+    pr::random_forest extended = trainer.extend(prior);
+    bool changed = extended.estimators().size()==20;
+    for(int_t n = 1 ; n <= 8 ; ++n)
+      changed = changed && argmax(prior.predict({n, 7}))==0 && argmax(extended.predict({n, 7}))==2;
+    ADD_TEST("extend", changed)
+  }
+
+  if(nfail>0)
+    return EXIT_FAILURE;
+  return EXIT_SUCCESS;
+}